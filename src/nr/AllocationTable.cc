@@ -0,0 +1,120 @@
+#include "AllocationTable.h"
+#include <stdexcept>
+
+namespace nr {
+
+AllocationTable::AllocationTable()
+{
+}
+
+int AllocationTable::insert(const Allocation& allocation)
+{
+    int slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else {
+        if (slots.size() >= INDEX_MASK) {
+            throw std::length_error("AllocationTable: too many active allocations");
+        }
+        slot = static_cast<int>(slots.size());
+        slots.push_back(Slot{1, -1});
+    }
+
+    slots[slot].position = static_cast<int>(values.size());
+    values.push_back(allocation);
+    valueSlots.push_back(slot);
+    return makeHandle(slot);
+}
+
+bool AllocationTable::erase(int handle)
+{
+    int slot = decodeSlot(handle);
+    if (slot < 0) {
+        return false;
+    }
+
+    // Move the last dense value into the hole
+    int position = slots[slot].position;
+    int last = static_cast<int>(values.size()) - 1;
+    if (position != last) {
+        values[position] = values[last];
+        valueSlots[position] = valueSlots[last];
+        slots[valueSlots[position]].position = position;
+    }
+    values.pop_back();
+    valueSlots.pop_back();
+
+    // Invalidate outstanding handles; generation 0 is never used so ids stay positive
+    Slot& freed = slots[slot];
+    freed.position = -1;
+    freed.generation = (freed.generation + 1) & GENERATION_MASK;
+    if (freed.generation == 0) {
+        freed.generation = 1;
+    }
+    freeSlots.push_back(slot);
+    return true;
+}
+
+void AllocationTable::clear()
+{
+    // Keep generations so handles from before the clear stay invalid
+    freeSlots.clear();
+    for (size_t i = 0; i < slots.size(); i++) {
+        if (slots[i].position >= 0) {
+            slots[i].position = -1;
+            slots[i].generation = (slots[i].generation + 1) & GENERATION_MASK;
+            if (slots[i].generation == 0) {
+                slots[i].generation = 1;
+            }
+        }
+        freeSlots.push_back(static_cast<int>(i));
+    }
+    values.clear();
+    valueSlots.clear();
+}
+
+bool AllocationTable::contains(int handle) const
+{
+    return decodeSlot(handle) >= 0;
+}
+
+const Allocation* AllocationTable::find(int handle) const
+{
+    int slot = decodeSlot(handle);
+    return slot >= 0 ? &values[slots[slot].position] : nullptr;
+}
+
+int AllocationTable::handleAt(size_t position) const
+{
+    return makeHandle(valueSlots[position]);
+}
+
+int AllocationTable::makeHandle(int slot) const
+{
+    // Slot index is stored off by one so a handle is never 0
+    return static_cast<int>((slots[slot].generation << INDEX_BITS) | static_cast<uint32_t>(slot + 1));
+}
+
+int AllocationTable::decodeSlot(int handle) const
+{
+    if (handle <= 0) {
+        return -1;
+    }
+
+    uint32_t raw = static_cast<uint32_t>(handle);
+    int slot = static_cast<int>(raw & INDEX_MASK) - 1;
+    uint32_t generation = raw >> INDEX_BITS;
+    if (slot < 0 || slot >= static_cast<int>(slots.size())) {
+        return -1;
+    }
+
+    const Slot& entry = slots[slot];
+    if (entry.position < 0 || entry.generation != generation) {
+        return -1;
+    }
+    return slot;
+}
+
+}  // namespace nr
\ No newline at end of file
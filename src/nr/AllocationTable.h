@@ -0,0 +1,80 @@
+#ifndef __ALLOCATION_TABLE_H
+#define __ALLOCATION_TABLE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "ResourcePool.h"
+
+namespace nr {
+
+/**
+ * @brief Record of one granted allocation
+ */
+struct Allocation {
+    BlockRange blocks;       ///< Pool blocks held by the allocation
+    int priority;            ///< Priority it was granted with
+    int64_t expirySlot;      ///< Slot the allocation expires in, -1 if it does not
+
+    Allocation() : priority(0), expirySlot(-1) {}
+    Allocation(const BlockRange& blocks, int priority, int64_t expirySlot = -1) :
+        blocks(blocks), priority(priority), expirySlot(expirySlot) {}
+};
+
+/**
+ * @brief Per-manager slot map of active allocations with generational handles
+ *
+ * Allocations are stored densely; a slot array maps handle indices to dense
+ * positions. A handle packs the slot index and the slot's generation into
+ * a positive int, and the generation is bumped on every erase, so a handle
+ * that outlives its allocation is detected instead of aliasing a newer one.
+ * Insert, lookup and erase are O(1) and reuse storage after warm-up.
+ */
+class AllocationTable
+{
+  public:
+    AllocationTable();
+
+    // Modification
+    int insert(const Allocation& allocation);
+    bool erase(int handle);
+    void clear();
+
+    // Lookup
+    bool contains(int handle) const;
+    const Allocation* find(int handle) const;
+    size_t size() const { return values.size(); }
+    bool empty() const { return values.empty(); }
+    size_t getMemoryFootprint() const {
+        return slots.capacity() * sizeof(Slot) + values.capacity() * sizeof(Allocation) +
+               (freeSlots.capacity() + valueSlots.capacity()) * sizeof(int);
+    }
+
+    // Dense iteration in unspecified order
+    const Allocation& valueAt(size_t position) const { return values[position]; }
+    int handleAt(size_t position) const;
+
+  private:
+    // Tables are pool-sized, so few index bits leave a wide generation for reused slots
+    static const int INDEX_BITS = 14;
+    static const uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+    static const uint32_t GENERATION_MASK = (1u << (31 - INDEX_BITS)) - 1;
+
+    struct Slot {
+        uint32_t generation;   ///< Bumped whenever the slot is freed
+        int position;          ///< Index into values, -1 while free
+    };
+
+    std::vector<Slot> slots;
+    std::vector<int> freeSlots;
+    std::vector<Allocation> values;
+    std::vector<int> valueSlots;   ///< Slot index owning each dense value
+
+    int makeHandle(int slot) const;
+    int decodeSlot(int handle) const;
+};
+
+}  // namespace nr
+
+#endif // __ALLOCATION_TABLE_H
\ No newline at end of file
@@ -0,0 +1,316 @@
+#include "ChannelOccupancyStore.h"
+#include "InterferenceKernels.h"
+#include "NeighborIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace nr {
+
+Define_Module(ChannelOccupancyStore);
+Register_Class(TransmissionBatch);
+
+ChannelOccupancyStore::ChannelOccupancyStore() :
+    windowSlots(0),
+    slotDuration(0),
+    pathlossFactor(0),
+    recordCount(0),
+    lastSweepSlot(0),
+    neighborIndex(nullptr),
+    positionMargin(0),
+    outbox(nullptr),
+    forwardTimer(nullptr),
+    totalTransmissions(0),
+    totalViews(0),
+    peakRecords(0),
+    remoteTransmissions(0),
+    forwardedBatches(0),
+    firstSlot(-1)
+{
+}
+
+ChannelOccupancyStore::~ChannelOccupancyStore()
+{
+    cancelAndDelete(forwardTimer);
+    delete outbox;
+}
+
+void ChannelOccupancyStore::initialize()
+{
+    slotDuration = par("slotDuration");
+    simtime_t window = par("sensingWindow");
+    double carrierFrequency = par("carrierFrequency").doubleValue();
+    
+    if (slotDuration <= 0 || window <= 0) {
+        throw cRuntimeError("Invalid sensing window %f or slot duration %f",
+                            SIMTIME_DBL(window), SIMTIME_DBL(slotDuration));
+    }
+    if (carrierFrequency <= 0) {
+        throw cRuntimeError("Invalid carrier frequency %f", carrierFrequency);
+    }
+    
+    windowSlots = static_cast<int>(std::ceil(window / slotDuration));
+    pathlossFactor = interference::freeSpaceFactor(carrierFrequency);  // The same loss as InterferenceCalculator
+    
+    // Optional spatial index restricting views to nearby transmitters
+    const char* indexName = par("neighborIndexModule").stringValue();
+    if (*indexName) {
+        // The index is not partitioned; other partitions only hold a placeholder of it
+        cModule* indexModule = getSimulation()->getSystemModule()->getSubmodule(indexName);
+        if (!indexModule || indexModule->isPlaceholder()) {
+            throw cRuntimeError("Neighbor index '%s' not found in this partition", indexName);
+        }
+        neighborIndex = check_and_cast<NeighborIndex*>(indexModule);
+        positionMargin = par("positionMargin").doubleValue();
+    }
+    
+    // Only needed when there are other partitions to forward to
+    if (gateSize("out") > 0) {
+        outbox = new TransmissionBatch();
+        forwardTimer = new cMessage("forwardTransmissions");
+        forwardTimer->setSchedulingPriority(1);  // After the events that record at this time
+    }
+    
+    WATCH(totalTransmissions);
+    WATCH(peakRecords);
+    WATCH(remoteTransmissions);
+    
+    EV_INFO << "ChannelOccupancyStore initialized with a window of " << windowSlots << " slots" << endl;
+}
+
+void ChannelOccupancyStore::handleMessage(cMessage *msg)
+{
+    if (msg == forwardTimer) {
+        forwardOutbox();
+        return;
+    }
+    
+    TransmissionBatch* batch = dynamic_cast<TransmissionBatch*>(msg);
+    if (!batch) {
+        throw cRuntimeError("ChannelOccupancyStore only processes transmission batches");
+    }
+    receiveBatch(batch);
+}
+
+void ChannelOccupancyStore::finish()
+{
+    recordScalar("storedTransmissions", totalTransmissions);
+    recordScalar("storeViews", totalViews);
+    recordScalar("peakStoreRecords", peakRecords);
+    recordScalar("storeMemory", getMemoryFootprint(), "B");
+    if (outbox) {
+        recordScalar("remoteTransmissions", remoteTransmissions);
+        recordScalar("forwardedBatches", forwardedBatches);
+    }
+}
+
+int64_t ChannelOccupancyStore::currentSlot() const
+{
+    return static_cast<int64_t>(std::floor(simTime() / slotDuration + 1e-9));
+}
+
+void ChannelOccupancyStore::expireTrack(std::deque<TransmissionRecord>& track, int64_t slot)
+{
+    // Records are kept in slot order, so the expired ones are at the front
+    while (!track.empty() && track.front().slot <= slot - windowSlots) {
+        track.pop_front();
+        recordCount--;
+    }
+}
+
+void ChannelOccupancyStore::expireRecords(int64_t slot)
+{
+    // Views expire the tracks they read; a sweep per window bounds the memory of the others
+    if (slot - lastSweepSlot < windowSlots) {
+        return;
+    }
+    lastSweepSlot = slot;
+    for (auto it = tracks.begin(); it != tracks.end(); ) {
+        expireTrack(it->second, slot);
+        it = it->second.empty() ? tracks.erase(it) : std::next(it);
+    }
+}
+
+void ChannelOccupancyStore::recordTransmission(int transmitterId, const inet::Coord& position,
+                                               int firstSubchannel, int numSubchannels, double txPowerDbm)
+{
+    Enter_Method_Silent();
+    
+    if (firstSubchannel < 0 || numSubchannels <= 0) {
+        EV_WARN << "Ignoring transmission with invalid subchannels from " << transmitterId << endl;
+        return;
+    }
+    
+    int64_t slot = currentSlot();
+    expireRecords(slot);
+    if (firstSlot < 0) {
+        firstSlot = slot;
+    }
+    
+    TransmissionRecord record;
+    record.slot = slot;
+    record.transmitterId = transmitterId;
+    record.position = position;
+    record.firstSubchannel = firstSubchannel;
+    record.numSubchannels = numSubchannels;
+    record.powerMw = static_cast<float>(std::pow(10.0, txPowerDbm / 10.0));
+    tracks[transmitterId].push_back(record);
+    recordCount++;
+    
+    totalTransmissions++;
+    peakRecords = std::max(peakRecords, recordCount);
+    
+    // Other partitions get it in one batch once every module has acted at this time
+    if (outbox) {
+        outbox->records.push_back(record);
+        if (!forwardTimer->isScheduled()) {
+            scheduleAt(simTime(), forwardTimer);
+        }
+    }
+}
+
+void ChannelOccupancyStore::insertRecord(const TransmissionRecord& record)
+{
+    // Remote records arrive a slot late, so they belong near the back
+    std::deque<TransmissionRecord>& track = tracks[record.transmitterId];
+    auto position = track.end();
+    while (position != track.begin() && std::prev(position)->slot > record.slot) {
+        --position;
+    }
+    track.insert(position, record);
+    recordCount++;
+}
+
+void ChannelOccupancyStore::forwardOutbox()
+{
+    if (outbox->records.empty()) {
+        return;
+    }
+    
+    // The connection delay is the lookahead of the parallel simulation
+    int peers = gateSize("out");
+    for (int i = 0; i < peers; i++) {
+        send(i == peers - 1 ? outbox : outbox->dup(), "out", i);
+    }
+    outbox = new TransmissionBatch();
+    forwardedBatches++;
+}
+
+void ChannelOccupancyStore::receiveBatch(TransmissionBatch* batch)
+{
+    int64_t slot = currentSlot();
+    expireRecords(slot);
+    for (const TransmissionRecord& record : batch->records) {
+        if (record.slot <= slot - windowSlots) {
+            continue;  // Already outside the window
+        }
+        if (firstSlot < 0 || record.slot < firstSlot) {
+            firstSlot = record.slot;
+        }
+        insertRecord(record);
+    }
+    remoteTransmissions += batch->records.size();
+    peakRecords = std::max(peakRecords, recordCount);
+    delete batch;
+}
+
+int64_t ChannelOccupancyStore::fillView(int receiverId, const inet::Coord& position, double range,
+                                        std::vector<float>& windowSum)
+{
+    Enter_Method_Silent();
+    
+    std::fill(windowSum.begin(), windowSum.end(), 0.0f);
+    int64_t slot = currentSlot();
+    expireRecords(slot);
+    totalViews++;
+    if (firstSlot < 0) {
+        return 0;
+    }
+    
+    // A UE cannot hear itself
+    if (neighborIndex) {
+        // Transmitters that are now farther than the margin beyond the range are skipped
+        neighborIndex->queryRadius(position, range + positionMargin, neighborScratch);
+        for (int transmitterId : neighborScratch) {
+            auto it = tracks.find(transmitterId);
+            if (transmitterId != receiverId && it != tracks.end()) {
+                accumulateTrack(it->second, slot, position, range, windowSum);
+            }
+        }
+    }
+    else {
+        for (auto& entry : tracks) {
+            if (entry.first != receiverId) {
+                accumulateTrack(entry.second, slot, position, range, windowSum);
+            }
+        }
+    }
+    return std::min<int64_t>(slot - firstSlot + 1, windowSlots);
+}
+
+void ChannelOccupancyStore::accumulateTrack(std::deque<TransmissionRecord>& track, int64_t slot,
+                                            const inet::Coord& position, double range,
+                                            std::vector<float>& windowSum)
+{
+    expireTrack(track, slot);
+    int subchannels = static_cast<int>(windowSum.size());
+    double rangeSquared = range * range;
+    for (const TransmissionRecord& record : track) {
+        // Transmitters out of range leave no trace
+        double distanceSquared = position.sqrdist(record.position);
+        if (distanceSquared > rangeSquared) {
+            continue;
+        }
+        
+        // Free-space loss, clamped at 1 m so co-located nodes stay finite
+        float received = static_cast<float>(record.powerMw / (pathlossFactor * std::max(distanceSquared, 1.0)));
+        int end = std::min(record.firstSubchannel + record.numSubchannels, subchannels);
+        for (int sc = record.firstSubchannel; sc < end; sc++) {
+            windowSum[sc] += received;
+        }
+    }
+}
+
+void TransmissionBatch::parsimPack(cCommBuffer* buffer) const
+{
+    cMessage::parsimPack(buffer);
+    buffer->pack(static_cast<int>(records.size()));
+    for (const TransmissionRecord& record : records) {
+        buffer->pack(static_cast<long long>(record.slot));
+        buffer->pack(record.transmitterId);
+        buffer->pack(record.position.x);
+        buffer->pack(record.position.y);
+        buffer->pack(record.position.z);
+        buffer->pack(record.firstSubchannel);
+        buffer->pack(record.numSubchannels);
+        buffer->pack(record.powerMw);
+    }
+}
+
+void TransmissionBatch::parsimUnpack(cCommBuffer* buffer)
+{
+    cMessage::parsimUnpack(buffer);
+    int count;
+    buffer->unpack(count);
+    records.resize(count);
+    for (TransmissionRecord& record : records) {
+        long long slot;
+        buffer->unpack(slot);
+        record.slot = slot;
+        buffer->unpack(record.transmitterId);
+        buffer->unpack(record.position.x);
+        buffer->unpack(record.position.y);
+        buffer->unpack(record.position.z);
+        buffer->unpack(record.firstSubchannel);
+        buffer->unpack(record.numSubchannels);
+        buffer->unpack(record.powerMw);
+    }
+}
+
+size_t ChannelOccupancyStore::getMemoryFootprint() const
+{
+    return sizeof(*this) + recordCount * sizeof(TransmissionRecord) +
+           tracks.size() * sizeof(std::deque<TransmissionRecord>);
+}
+
+}  // namespace nr
\ No newline at end of file
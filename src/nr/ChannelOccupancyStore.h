@@ -0,0 +1,142 @@
+#ifndef __CHANNEL_OCCUPANCY_STORE_H
+#define __CHANNEL_OCCUPANCY_STORE_H
+
+#include <omnetpp.h>
+#include <inet/common/INETDefs.h>
+#include <inet/common/geometry/common/Coord.h>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+using namespace omnetpp;
+
+namespace nr {
+
+class NeighborIndex;
+
+/**
+ * @brief One sidelink transmission as seen by the shared store
+ */
+struct TransmissionRecord {
+    int64_t slot;            ///< Slot the transmission started in
+    int transmitterId;       ///< Module id of the transmitting NRModule
+    inet::Coord position;    ///< Transmitter position at transmission time
+    int firstSubchannel;     ///< First subchannel used
+    int numSubchannels;      ///< Number of subchannels used
+    float powerMw;           ///< Transmit power per subchannel in mW
+};
+
+/**
+ * @brief Transmissions one store forwards to the stores of other partitions
+ *
+ * Carries the records made in one event, so a slot costs one message per
+ * peer however many UEs transmitted in it. Packs itself for the parallel
+ * simulation layer.
+ */
+class TransmissionBatch : public cMessage
+{
+  public:
+    std::vector<TransmissionRecord> records;
+    
+  public:
+    TransmissionBatch(const char* name = "transmissionBatch") : cMessage(name) {}
+    TransmissionBatch(const TransmissionBatch& other) : cMessage(other), records(other.records) {}
+    virtual TransmissionBatch* dup() const override { return new TransmissionBatch(*this); }
+    
+    // Parallel simulation serialization
+    virtual void parsimPack(cCommBuffer* buffer) const override;
+    virtual void parsimUnpack(cCommBuffer* buffer) override;
+};
+
+/**
+ * @brief Network-wide, slot-indexed record of sidelink channel occupancy
+ *
+ * Instead of every UE keeping its own sensing window and updating it for
+ * every transmission it hears, transmitters record each transmission once
+ * here. A UE that needs to select resources asks for a view: the window
+ * sums of received power per subchannel, restricted to transmitters within
+ * its reception range and attenuated by free-space path loss. Memory and
+ * update cost therefore scale with the number of transmissions in the
+ * window, and the per-UE cost is only paid when a UE actually selects.
+ *
+ * Records are kept per transmitter. With a NeighborIndex configured, a
+ * view only visits the transmitters that are currently within the range
+ * plus a margin for the distance they may have moved within the window,
+ * instead of every transmission in the window.
+ *
+ * In a parallel run there is one store per partition, and UEs only talk
+ * to the store of their own partition. Each store forwards the records
+ * made locally to its peers over its out gates, batched per event; the
+ * connections carry the slot duration as delay, which is the lookahead.
+ * Remote transmissions therefore show up in views one slot late.
+ */
+class ChannelOccupancyStore : public cSimpleModule
+{
+  protected:
+    // Configuration parameters
+    int windowSlots;             ///< Length of the sensing window in slots
+    simtime_t slotDuration;      ///< Slot length used for indexing
+    double pathlossFactor;       ///< (4*pi*f/c)^2, free-space loss per squared metre
+    
+    // Transmissions in the window per transmitter, oldest first
+    std::unordered_map<int, std::deque<TransmissionRecord>> tracks;
+    size_t recordCount;
+    int64_t lastSweepSlot;       ///< Slot all tracks were last expired in
+    
+    // Spatial index of the transmitters, null when views scan all of them
+    NeighborIndex* neighborIndex;
+    double positionMargin;       ///< Extra query radius for movement since a transmission, in m
+    std::vector<int> neighborScratch;
+    
+    // Local records not yet forwarded to the other partitions
+    TransmissionBatch* outbox;
+    cMessage* forwardTimer;
+    
+    // Statistics
+    long totalTransmissions;
+    long totalViews;
+    size_t peakRecords;
+    long remoteTransmissions;    ///< Records received from other partitions
+    long forwardedBatches;
+    
+  protected:
+    // OMNeT++ module interface
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+    
+    // Internal utility functions
+    int64_t currentSlot() const;
+    void expireRecords(int64_t slot);
+    void expireTrack(std::deque<TransmissionRecord>& track, int64_t slot);
+    void accumulateTrack(std::deque<TransmissionRecord>& track, int64_t slot,
+                         const inet::Coord& position, double range, std::vector<float>& windowSum);
+    void insertRecord(const TransmissionRecord& record);
+    void forwardOutbox();
+    void receiveBatch(TransmissionBatch* batch);
+    
+  public:
+    ChannelOccupancyStore();
+    virtual ~ChannelOccupancyStore();
+    
+    // Transmission input
+    void recordTransmission(int transmitterId, const inet::Coord& position,
+                            int firstSubchannel, int numSubchannels, double txPowerDbm);
+    
+    // Range-filtered view of the window, returns the number of observed slots
+    int64_t fillView(int receiverId, const inet::Coord& position, double range,
+                     std::vector<float>& windowSum);
+    
+    // Status queries
+    size_t getRecordCount() const { return recordCount; }
+    int getWindowSlots() const { return windowSlots; }
+    size_t getMemoryFootprint() const;
+    
+  private:
+    int64_t firstSlot;           ///< First slot with a record, -1 before any
+};
+
+}  // namespace nr
+
+#endif // __CHANNEL_OCCUPANCY_STORE_H
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "FreeExtentIndex.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace nr {
+
+FreeExtentIndex::FreeExtentIndex() :
+    numBlocks(0),
+    leafCount(1)
+{
+    reset(0);
+}
+
+void FreeExtentIndex::reset(int blocks)
+{
+    if (blocks < 0) {
+        throw std::invalid_argument("FreeExtentIndex: negative size");
+    }
+
+    numBlocks = blocks;
+    leafCount = 1;
+    while (leafCount < numBlocks) {
+        leafCount <<= 1;
+    }
+
+    // Padding leaves past the pool are permanently occupied
+    nodes.assign(2 * leafCount, Node{0, 0, 0});
+    for (int i = 0; i < numBlocks; i++) {
+        nodes[leafCount + i] = Node{1, 1, 1};
+    }
+    for (int levelStart = leafCount / 2, childSpan = 1; levelStart >= 1; levelStart /= 2, childSpan <<= 1) {
+        for (int node = levelStart; node < 2 * levelStart; node++) {
+            pull(node, childSpan);
+        }
+    }
+}
+
+void FreeExtentIndex::markOccupied(int first, int count)
+{
+    assignRange(first, count, false);
+}
+
+void FreeExtentIndex::markFree(int first, int count)
+{
+    assignRange(first, count, true);
+}
+
+int FreeExtentIndex::findFirstFit(int length) const
+{
+    if (length <= 0 || numBlocks == 0 || nodes[1].best < length) {
+        return -1;
+    }
+
+    int node = 1;
+    int offset = 0;
+    int span = leafCount;
+    while (node < leafCount) {
+        int left = 2 * node;
+        int right = left + 1;
+        int half = span / 2;
+
+        if (nodes[left].best >= length) {
+            node = left;
+        }
+        else if (nodes[left].suffix + nodes[right].prefix >= length) {
+            // Run straddles the midpoint
+            return offset + half - nodes[left].suffix;
+        }
+        else {
+            node = right;
+            offset += half;
+        }
+        span = half;
+    }
+    return offset;
+}
+
+int FreeExtentIndex::longestFreeRun() const
+{
+    return numBlocks > 0 ? nodes[1].best : 0;
+}
+
+void FreeExtentIndex::assignRange(int first, int count, bool free)
+{
+    if (count <= 0) {
+        return;
+    }
+    if (first < 0 || first + count > numBlocks) {
+        throw std::out_of_range("FreeExtentIndex: range outside pool");
+    }
+
+    int lo = leafCount + first;
+    int hi = leafCount + first + count - 1;
+    int value = free ? 1 : 0;
+    for (int leaf = lo; leaf <= hi; leaf++) {
+        nodes[leaf] = Node{value, value, value};
+    }
+
+    // Recompute every ancestor of the touched leaves, one level at a time
+    int childSpan = 1;
+    while (lo > 1) {
+        lo >>= 1;
+        hi >>= 1;
+        for (int node = lo; node <= hi; node++) {
+            pull(node, childSpan);
+        }
+        childSpan <<= 1;
+    }
+}
+
+void FreeExtentIndex::pull(int node, int childSpan)
+{
+    const Node& left = nodes[2 * node];
+    const Node& right = nodes[2 * node + 1];
+    Node& parent = nodes[node];
+
+    parent.prefix = left.prefix == childSpan ? childSpan + right.prefix : left.prefix;
+    parent.suffix = right.suffix == childSpan ? childSpan + left.suffix : right.suffix;
+    parent.best = std::max(std::max(left.best, right.best), left.suffix + right.prefix);
+}
+
+}  // namespace nr
\ No newline at end of file
@@ -0,0 +1,53 @@
+#ifndef __FREE_EXTENT_INDEX_H
+#define __FREE_EXTENT_INDEX_H
+
+#include <vector>
+#include <cstddef>
+
+namespace nr {
+
+/**
+ * @brief Segment tree over the resource pool answering first-fit queries
+ *
+ * Every node keeps the length of the free run touching its left edge, the
+ * free run touching its right edge and the longest free run inside it.
+ * The first run of at least N free blocks is found by a single root-to-leaf
+ * descent in O(log n). Range updates recompute only the touched leaves and
+ * their ancestors, O(k + log n) for a range of k blocks.
+ */
+class FreeExtentIndex
+{
+  public:
+    FreeExtentIndex();
+
+    // Sizing, all blocks start out free
+    void reset(int numBlocks);
+    int size() const { return numBlocks; }
+
+    // Incremental updates over [first, first + count)
+    void markOccupied(int first, int count);
+    void markFree(int first, int count);
+
+    // Queries
+    int findFirstFit(int length) const;
+    int longestFreeRun() const;
+    size_t getMemoryFootprint() const { return nodes.capacity() * sizeof(Node); }
+
+  private:
+    struct Node {
+        int prefix;   ///< Free blocks at the left edge of the node
+        int suffix;   ///< Free blocks at the right edge of the node
+        int best;     ///< Longest free run inside the node
+    };
+
+    int numBlocks;
+    int leafCount;             ///< Leaves rounded up to a power of two
+    std::vector<Node> nodes;   ///< Implicit tree, root at 1, leaves from leafCount
+
+    void assignRange(int first, int count, bool free);
+    void pull(int node, int childSpan);
+};
+
+}  // namespace nr
+
+#endif // __FREE_EXTENT_INDEX_H
\ No newline at end of file
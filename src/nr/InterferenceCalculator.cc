@@ -0,0 +1,164 @@
+#include "InterferenceCalculator.h"
+#include "InterferenceKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace nr {
+
+const uint32_t InterferenceCalculator::INVALID;
+
+InterferenceCalculator::InterferenceCalculator() :
+    pathlossFactor(1),
+    noise(0),
+    reuseDistanceSquared(0),
+    caching(false),
+    cacheHits(0),
+    cacheMisses(0)
+{
+}
+
+void InterferenceCalculator::configure(double carrierFrequency, double reuseDistance, double noisePowerMw)
+{
+    if (carrierFrequency <= 0 || reuseDistance < 0 || noisePowerMw < 0) {
+        throw std::invalid_argument("Invalid interference calculator configuration");
+    }
+    pathlossFactor = static_cast<float>(interference::freeSpaceFactor(carrierFrequency));
+    noise = static_cast<float>(noisePowerMw);
+    reuseDistanceSquared = reuseDistance * reuseDistance;
+    caching = reuseDistance > 0;
+    rows.clear();
+    std::fill(versions.begin(), versions.end(), 0);
+    anchorX = posX;
+    anchorY = posY;
+}
+
+void InterferenceCalculator::ensureNode(int node)
+{
+    if (node < 0) {
+        throw std::invalid_argument("Node ids must not be negative");
+    }
+    if (node >= static_cast<int>(posX.size())) {
+        size_t count = node + 1;
+        posX.resize(count, 0.0f);
+        posY.resize(count, 0.0f);
+        anchorX.resize(count, 0.0f);
+        anchorY.resize(count, 0.0f);
+        versions.resize(count, 0);
+    }
+}
+
+void InterferenceCalculator::setPosition(int node, double x, double y)
+{
+    ensureNode(node);
+    posX[node] = static_cast<float>(x);
+    posY[node] = static_cast<float>(y);
+    
+    // Small moves keep the cached gains; a larger one invalidates them and re-anchors the node
+    double dx = x - anchorX[node];
+    double dy = y - anchorY[node];
+    if (dx * dx + dy * dy > reuseDistanceSquared) {
+        anchorX[node] = posX[node];
+        anchorY[node] = posY[node];
+        versions[node] = (versions[node] + 1) % INVALID;
+    }
+}
+
+void InterferenceCalculator::gatherGains(int receiver, const int* transmitters, int numTx)
+{
+    gains.resize(numTx);
+    float rxX = posX[receiver];
+    float rxY = posY[receiver];
+    missX.clear();
+    missY.clear();
+    missSlot.clear();
+    
+    Row* row = nullptr;
+    if (caching) {
+        if (receiver >= static_cast<int>(rows.size())) {
+            rows.resize(receiver + 1, Row{INVALID, {}, {}});
+        }
+        row = &rows[receiver];
+        size_t nodes = posX.size();
+        if (row->receiverVersion != versions[receiver]) {
+            // The receiver moved (or is new), so none of its gains hold
+            row->receiverVersion = versions[receiver];
+            row->gain.assign(nodes, 0.0f);
+            row->version.assign(nodes, INVALID);
+        }
+        else if (row->gain.size() < nodes) {
+            // Nodes joined since; only their entries are new
+            row->gain.resize(nodes, 0.0f);
+            row->version.resize(nodes, INVALID);
+        }
+    }
+    
+    // Cached gains are copied, the others gathered for one kernel call
+    for (int i = 0; i < numTx; i++) {
+        int tx = transmitters[i];
+        if (row && row->version[tx] == versions[tx]) {
+            gains[i] = row->gain[tx];
+            continue;
+        }
+        missX.push_back(posX[tx]);
+        missY.push_back(posY[tx]);
+        missSlot.push_back(i);
+    }
+    
+    int misses = static_cast<int>(missSlot.size());
+    cacheHits += numTx - misses;
+    cacheMisses += misses;
+    missGain.resize(misses);
+    interference::freeSpaceGain(missX.data(), missY.data(), rxX, rxY, pathlossFactor, missGain.data(), misses);
+    for (int m = 0; m < misses; m++) {
+        int slot = missSlot[m];
+        gains[slot] = missGain[m];
+        if (row) {
+            int tx = transmitters[slot];
+            row->gain[tx] = missGain[m];
+            row->version[tx] = versions[tx];
+        }
+    }
+    
+    // A node does not receive its own transmission
+    for (int i = 0; i < numTx; i++) {
+        if (transmitters[i] == receiver) {
+            gains[i] = 0.0f;
+        }
+    }
+}
+
+void InterferenceCalculator::computeReceiver(int receiver, const int* transmitters, const float* txPowerMw, int numTx,
+                                             float* received, float* sinr)
+{
+    ensureNode(receiver);
+    for (int i = 0; i < numTx; i++) {
+        ensureNode(transmitters[i]);
+    }
+    
+    gatherGains(receiver, transmitters, numTx);
+    interference::multiply(txPowerMw, gains.data(), received, numTx);
+    float total = interference::sum(received, numTx);
+    interference::sinr(received, total, noise, sinr, numTx);
+}
+
+void InterferenceCalculator::compute(const int* receivers, int numRx, const int* transmitters, const float* txPowerMw,
+                                     int numTx, float* received, float* sinr)
+{
+    for (int r = 0; r < numRx; r++) {
+        size_t offset = static_cast<size_t>(r) * numTx;
+        computeReceiver(receivers[r], transmitters, txPowerMw, numTx, received + offset, sinr + offset);
+    }
+}
+
+size_t InterferenceCalculator::getMemoryFootprint() const
+{
+    size_t bytes = sizeof(*this) + posX.capacity() * 4 * sizeof(float) + versions.capacity() * sizeof(uint32_t) +
+                   rows.capacity() * sizeof(Row);
+    for (const Row& row : rows) {
+        bytes += row.gain.capacity() * sizeof(float) + row.version.capacity() * sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+}  // namespace nr
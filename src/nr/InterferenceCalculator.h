@@ -0,0 +1,90 @@
+#ifndef __INTERFERENCE_CALCULATOR_H
+#define __INTERFERENCE_CALCULATOR_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace nr {
+
+/**
+ * @brief Batched received power and SINR over the active transmitters of a slot
+ *
+ * Node positions are kept as structure of arrays and pathloss is computed
+ * by the vector kernels in InterferenceKernels, free-space like the shared
+ * occupancy store. Gains are cached per (receiver, transmitter) pair and
+ * reused while neither endpoint has moved more than the reuse distance
+ * from where it was when its gains were last invalidated; moving farther
+ * invalidates the node's cached gains and re-anchors it. With a reuse
+ * distance of 0 every gain is recomputed.
+ *
+ * The cache holds one row per node that has been a receiver, each row
+ * sized to the number of nodes, so its memory grows with receivers x
+ * nodes. Node ids are small non-negative integers.
+ */
+class InterferenceCalculator
+{
+  public:
+    InterferenceCalculator();
+
+    // Configuration, clears the cache
+    void configure(double carrierFrequency, double reuseDistance, double noisePowerMw);
+
+    // Node positions in m
+    void setPosition(int node, double x, double y);
+    int getNumNodes() const { return static_cast<int>(posX.size()); }
+
+    // Received power (mW) and SINR (linear) of every transmitter at one receiver;
+    // a receiver that is also transmitting gets 0 from itself
+    void computeReceiver(int receiver, const int* transmitters, const float* txPowerMw, int numTx,
+                         float* received, float* sinr);
+
+    // Same for a set of receivers, outputs are numRx x numTx, row-major
+    void compute(const int* receivers, int numRx, const int* transmitters, const float* txPowerMw, int numTx,
+                 float* received, float* sinr);
+
+    // Statistics
+    uint64_t getCacheHits() const { return cacheHits; }
+    uint64_t getCacheMisses() const { return cacheMisses; }
+    size_t getMemoryFootprint() const;
+
+  private:
+    struct Row {
+        uint32_t receiverVersion;       ///< Receiver version the cached gains belong to
+        std::vector<float> gain;        ///< Indexed by transmitter
+        std::vector<uint32_t> version;  ///< Transmitter version per gain, INVALID if none
+    };
+
+    float pathlossFactor;
+    float noise;
+    double reuseDistanceSquared;
+    bool caching;
+
+    // Nodes, structure of arrays
+    std::vector<float> posX;
+    std::vector<float> posY;
+    std::vector<float> anchorX;
+    std::vector<float> anchorY;
+    std::vector<uint32_t> versions;    ///< Bumped whenever a node moves past the reuse distance
+
+    std::vector<Row> rows;             ///< Indexed by receiver
+
+    // Scratch arrays reused between calls
+    std::vector<float> gains;
+    std::vector<float> missX;
+    std::vector<float> missY;
+    std::vector<float> missGain;
+    std::vector<int> missSlot;
+
+    uint64_t cacheHits;
+    uint64_t cacheMisses;
+
+    static const uint32_t INVALID = 0xffffffffu;
+
+    void ensureNode(int node);
+    void gatherGains(int receiver, const int* transmitters, int numTx);
+};
+
+}  // namespace nr
+
+#endif // __INTERFERENCE_CALCULATOR_H
@@ -0,0 +1,143 @@
+#include "InterferenceKernels.h"
+#include <cmath>
+
+#if defined(__AVX2__) && !defined(NR_INTERFERENCE_SCALAR)
+#include <immintrin.h>
+#define NR_INTERFERENCE_AVX2 1
+#endif
+#if defined(__SSE2__) && !defined(NR_INTERFERENCE_SCALAR)
+#include <emmintrin.h>
+#define NR_INTERFERENCE_SSE 1
+#endif
+
+namespace nr {
+namespace interference {
+
+static const double SPEED_OF_LIGHT_MPS = 299792458.0;
+
+double freeSpaceFactor(double carrierFrequency)
+{
+    double k = 4 * M_PI * carrierFrequency / SPEED_OF_LIGHT_MPS;
+    return k * k;
+}
+
+void freeSpaceGain(const float* x, const float* y, float rxX, float rxY, float pathlossFactor, float* gain, int n)
+{
+    int i = 0;
+#ifdef NR_INTERFERENCE_AVX2
+    __m256 rx8 = _mm256_set1_ps(rxX);
+    __m256 ry8 = _mm256_set1_ps(rxY);
+    __m256 factor8 = _mm256_set1_ps(pathlossFactor);
+    __m256 one8 = _mm256_set1_ps(1.0f);
+    for (; i + 8 <= n; i += 8) {
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x + i), rx8);
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(y + i), ry8);
+        __m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        __m256 loss = _mm256_mul_ps(factor8, _mm256_max_ps(d2, one8));
+        _mm256_storeu_ps(gain + i, _mm256_div_ps(one8, loss));
+    }
+#endif
+#ifdef NR_INTERFERENCE_SSE
+    __m128 rx4 = _mm_set1_ps(rxX);
+    __m128 ry4 = _mm_set1_ps(rxY);
+    __m128 factor4 = _mm_set1_ps(pathlossFactor);
+    __m128 one4 = _mm_set1_ps(1.0f);
+    for (; i + 4 <= n; i += 4) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), rx4);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(y + i), ry4);
+        __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        __m128 loss = _mm_mul_ps(factor4, _mm_max_ps(d2, one4));
+        _mm_storeu_ps(gain + i, _mm_div_ps(one4, loss));
+    }
+#endif
+    for (; i < n; i++) {
+        float dx = x[i] - rxX;
+        float dy = y[i] - rxY;
+        float d2 = dx * dx + dy * dy;
+        gain[i] = 1.0f / (pathlossFactor * (d2 > 1.0f ? d2 : 1.0f));
+    }
+}
+
+void multiply(const float* a, const float* b, float* out, int n)
+{
+    int i = 0;
+#ifdef NR_INTERFERENCE_AVX2
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+#endif
+#ifdef NR_INTERFERENCE_SSE
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = a[i] * b[i];
+    }
+}
+
+float sum(const float* values, int n)
+{
+    int i = 0;
+    float total = 0;
+#ifdef NR_INTERFERENCE_AVX2
+    __m256 acc8 = _mm256_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        acc8 = _mm256_add_ps(acc8, _mm256_loadu_ps(values + i));
+    }
+    __m128 folded = _mm_add_ps(_mm256_castps256_ps128(acc8), _mm256_extractf128_ps(acc8, 1));
+    float lanes8[4];
+    _mm_storeu_ps(lanes8, folded);
+    total += (lanes8[0] + lanes8[1]) + (lanes8[2] + lanes8[3]);
+#endif
+#ifdef NR_INTERFERENCE_SSE
+    __m128 acc4 = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        acc4 = _mm_add_ps(acc4, _mm_loadu_ps(values + i));
+    }
+    float lanes4[4];
+    _mm_storeu_ps(lanes4, acc4);
+    total += (lanes4[0] + lanes4[1]) + (lanes4[2] + lanes4[3]);
+#endif
+    for (; i < n; i++) {
+        total += values[i];
+    }
+    return total;
+}
+
+void sinr(const float* received, float total, float noise, float* out, int n)
+{
+    int i = 0;
+#ifdef NR_INTERFERENCE_AVX2
+    __m256 base8 = _mm256_set1_ps(total + noise);
+    for (; i + 8 <= n; i += 8) {
+        __m256 signal = _mm256_loadu_ps(received + i);
+        _mm256_storeu_ps(out + i, _mm256_div_ps(signal, _mm256_sub_ps(base8, signal)));
+    }
+#endif
+#ifdef NR_INTERFERENCE_SSE
+    __m128 base4 = _mm_set1_ps(total + noise);
+    for (; i + 4 <= n; i += 4) {
+        __m128 signal = _mm_loadu_ps(received + i);
+        _mm_storeu_ps(out + i, _mm_div_ps(signal, _mm_sub_ps(base4, signal)));
+    }
+#endif
+    float base = total + noise;
+    for (; i < n; i++) {
+        out[i] = received[i] / (base - received[i]);
+    }
+}
+
+const char* instructionSet()
+{
+#if defined(NR_INTERFERENCE_AVX2)
+    return "avx2";
+#elif defined(NR_INTERFERENCE_SSE)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+}  // namespace interference
+}  // namespace nr
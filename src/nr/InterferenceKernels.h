@@ -0,0 +1,38 @@
+#ifndef __INTERFERENCE_KERNELS_H
+#define __INTERFERENCE_KERNELS_H
+
+namespace nr {
+namespace interference {
+
+/**
+ * @brief Vector kernels used by InterferenceCalculator
+ *
+ * All kernels work on contiguous float arrays of length n (structure of
+ * arrays). They use AVX2 when the build enables it (CMake option NR_AVX2),
+ * SSE when the compiler targets it (always the case on x86-64), and plain
+ * loops elsewhere or with NR_INTERFERENCE_SCALAR defined. Arrays need no
+ * particular alignment.
+ */
+
+/// Free-space loss per squared metre, (4 * pi * f / c)^2
+double freeSpaceFactor(double carrierFrequency);
+
+/// gain[i] = 1 / (pathlossFactor * max(d^2, 1)), d the distance from (x[i], y[i]) to (rxX, rxY)
+void freeSpaceGain(const float* x, const float* y, float rxX, float rxY, float pathlossFactor, float* gain, int n);
+
+/// out[i] = a[i] * b[i], used to turn gains into received powers
+void multiply(const float* a, const float* b, float* out, int n);
+
+/// Sum of values[0..n)
+float sum(const float* values, int n);
+
+/// sinr[i] = received[i] / (total - received[i] + noise)
+void sinr(const float* received, float total, float noise, float* out, int n);
+
+/// Name of the instruction set the kernels were compiled for
+const char* instructionSet();
+
+}  // namespace interference
+}  // namespace nr
+
+#endif // __INTERFERENCE_KERNELS_H
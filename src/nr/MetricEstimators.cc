@@ -0,0 +1,135 @@
+#include "MetricEstimators.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace nr {
+
+EwmaEstimator::EwmaEstimator(double a) :
+    alpha(0),
+    value(0),
+    count(0)
+{
+    setAlpha(a);
+}
+
+void EwmaEstimator::setAlpha(double a)
+{
+    if (!(a > 0 && a <= 1)) {
+        throw std::invalid_argument("EwmaEstimator: alpha must be in (0, 1]");
+    }
+    alpha = a;
+}
+
+void EwmaEstimator::reset()
+{
+    value = 0;
+    count = 0;
+}
+
+void EwmaEstimator::add(double sample, long repeats)
+{
+    if (repeats <= 0) {
+        return;
+    }
+    
+    // The first sample seeds the filter, as the L3 filter does with its first measurement
+    if (count == 0) {
+        value = sample;
+    }
+    else {
+        value = sample + std::pow(1 - alpha, static_cast<double>(repeats)) * (value - sample);
+    }
+    count += repeats;
+}
+
+double EwmaEstimator::l3FilterAlpha(int k)
+{
+    if (k < 0) {
+        throw std::invalid_argument("EwmaEstimator: negative L3 filter coefficient");
+    }
+    return std::pow(0.5, k / 4.0);
+}
+
+WindowedQuantile::WindowedQuantile() :
+    next(0),
+    filled(0),
+    lower(0),
+    bucketWidth(1)
+{
+}
+
+void WindowedQuantile::configure(size_t windowSize, double min, double max, int numBuckets)
+{
+    if (windowSize == 0 || numBuckets <= 0 || numBuckets > MAX_BUCKETS || !(max > min)) {
+        throw std::invalid_argument("WindowedQuantile: invalid window or range");
+    }
+    ring.assign(windowSize, 0);
+    counts.assign(numBuckets, 0);
+    lower = min;
+    bucketWidth = (max - min) / numBuckets;
+    next = 0;
+    filled = 0;
+}
+
+void WindowedQuantile::reset()
+{
+    std::fill(counts.begin(), counts.end(), 0);
+    next = 0;
+    filled = 0;
+}
+
+void WindowedQuantile::add(double sample, long repeats)
+{
+    if (ring.empty() || repeats <= 0) {
+        return;
+    }
+
+    int last = static_cast<int>(counts.size()) - 1;
+    int bucket = static_cast<int>(std::floor((sample - lower) / bucketWidth));
+    bucket = std::min(std::max(bucket, 0), last);
+
+    // A run at least as long as the window replaces all of it
+    if (static_cast<size_t>(repeats) >= ring.size()) {
+        std::fill(counts.begin(), counts.end(), 0);
+        std::fill(ring.begin(), ring.end(), static_cast<uint16_t>(bucket));
+        counts[bucket] = static_cast<uint32_t>(ring.size());
+        filled = ring.size();
+        next = 0;
+        return;
+    }
+
+    for (long i = 0; i < repeats; i++) {
+        // The oldest sample leaves the window once it is full
+        if (filled == ring.size()) {
+            counts[ring[next]]--;
+        }
+        else {
+            filled++;
+        }
+        ring[next] = static_cast<uint16_t>(bucket);
+        counts[bucket]++;
+        next = next + 1 == ring.size() ? 0 : next + 1;
+    }
+}
+
+double WindowedQuantile::quantile(double q) const
+{
+    if (filled == 0) {
+        return 0.0;
+    }
+
+    // Rank of the wanted sample, then the bucket holding it
+    double rank = std::min(std::max(q, 0.0), 1.0) * filled;
+    double below = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        if (counts[i] > 0 && below + counts[i] >= rank) {
+            double fraction = (rank - below) / counts[i];
+            return lower + (i + fraction) * bucketWidth;
+        }
+        below += counts[i];
+    }
+    return lower + counts.size() * bucketWidth;
+}
+
+}  // namespace nr
\ No newline at end of file
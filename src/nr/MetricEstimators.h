@@ -0,0 +1,83 @@
+#ifndef __METRIC_ESTIMATORS_H
+#define __METRIC_ESTIMATORS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nr {
+
+/**
+ * @brief Exponentially weighted moving average
+ *
+ * F(n) = (1 - a) * F(n-1) + a * M(n), seeded with the first sample. With
+ * a = 1/2^(k/4) this is the 3GPP layer 3 filter (TS 38.331, filterCoefficient
+ * k), applied to RSRP in the dB domain. A sample repeated r times is added
+ * in one step, F = M + (1 - a)^r * (F - M), so per-slot input does not
+ * depend on how many of the slots were visited.
+ */
+class EwmaEstimator
+{
+  public:
+    explicit EwmaEstimator(double alpha = 0.1);
+
+    void setAlpha(double alpha);
+    void reset();
+    void add(double sample, long repeats = 1);
+
+    bool hasValue() const { return count > 0; }
+    double getValue() const { return value; }
+    long getCount() const { return count; }
+    double getAlpha() const { return alpha; }
+
+    /// Smoothing factor of the layer 3 filter for filterCoefficient k
+    static double l3FilterAlpha(int k);
+
+  private:
+    double alpha;
+    double value;
+    long count;
+};
+
+/**
+ * @brief Quantiles over the last N samples
+ *
+ * Samples are binned into equal-width buckets over [min, max] (values
+ * outside are clamped to the end buckets) and the ring remembers the
+ * bucket of each of the last N samples. Adding a sample moves one count
+ * out of the oldest sample's bucket and one into the new one, so it is
+ * O(1) and allocation-free; a sample repeated r times costs min(r, N).
+ * A quantile scans the buckets and interpolates inside the one it falls
+ * in, so it is exact to within one bucket width.
+ */
+class WindowedQuantile
+{
+  public:
+    WindowedQuantile();
+
+    void configure(size_t windowSize, double min, double max, int numBuckets);
+    void reset();
+    void add(double sample, long repeats = 1);
+
+    bool empty() const { return filled == 0; }
+    size_t size() const { return filled; }
+    size_t getWindowSize() const { return ring.size(); }
+    size_t getMemoryFootprint() const {
+        return ring.capacity() * sizeof(uint16_t) + counts.capacity() * sizeof(uint32_t);
+    }
+    double quantile(double q) const;
+
+  private:
+    std::vector<uint16_t> ring;     ///< Bucket of each sample in the window
+    std::vector<uint32_t> counts;   ///< Samples per bucket
+    size_t next;                    ///< Ring position written next
+    size_t filled;                  ///< Valid samples in the ring
+    double lower;
+    double bucketWidth;
+
+    static const int MAX_BUCKETS = 65535;
+};
+
+}  // namespace nr
+
+#endif // __METRIC_ESTIMATORS_H
\ No newline at end of file
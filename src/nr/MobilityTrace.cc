@@ -0,0 +1,182 @@
+#include "MobilityTrace.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace nr {
+
+MobilityTraceWriter::MobilityTraceWriter(double stepLength) :
+    stepLength(stepLength),
+    numSamples(0)
+{
+}
+
+void MobilityTraceWriter::add(int index, int64_t step, const MobilityTraceSample& sample)
+{
+    auto inserted = tracks.emplace(index, Track());
+    Track& track = inserted.first->second;
+    if (inserted.second) {
+        track.firstStep = step;
+    }
+
+    int64_t offset = step - track.firstStep;
+    int64_t count = static_cast<int64_t>(track.samples.size());
+    if (offset < count - 1) {
+        return;  // Steps already written are not revisited
+    }
+    if (offset == count - 1) {
+        track.samples.back() = sample;
+        return;
+    }
+
+    // A vehicle that did not report in a step stayed where it was
+    if (count > 0) {
+        MobilityTraceSample held = track.samples.back();
+        track.samples.insert(track.samples.end(), static_cast<size_t>(offset - count), held);
+    }
+    track.samples.push_back(sample);
+    numSamples += track.samples.size() - count;
+}
+
+bool MobilityTraceWriter::write(const std::string& path) const
+{
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    MobilityTraceHeader header;
+    std::memcpy(header.magic, "NRMT", 4);
+    header.version = MobilityTraceReader::FILE_VERSION;
+    header.sampleSize = sizeof(MobilityTraceSample);
+    header.vehicleSize = sizeof(MobilityTraceVehicle);
+    header.stepLength = stepLength;
+    header.numVehicles = static_cast<uint32_t>(tracks.size());
+    header.reserved = 0;
+    header.numSamples = numSamples;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+
+    // Vehicle table first, so a reader finds any vehicle without touching samples
+    uint64_t firstSample = 0;
+    for (auto it = tracks.begin(); ok && it != tracks.end(); ++it) {
+        MobilityTraceVehicle vehicle;
+        vehicle.index = it->first;
+        vehicle.firstStep = static_cast<int32_t>(it->second.firstStep);
+        vehicle.numSteps = static_cast<int32_t>(it->second.samples.size());
+        vehicle.reserved = 0;
+        vehicle.firstSample = firstSample;
+        ok = std::fwrite(&vehicle, sizeof(vehicle), 1, file) == 1;
+        firstSample += it->second.samples.size();
+    }
+    for (auto it = tracks.begin(); ok && it != tracks.end(); ++it) {
+        const std::vector<MobilityTraceSample>& samples = it->second.samples;
+        ok = std::fwrite(samples.data(), sizeof(MobilityTraceSample), samples.size(), file) == samples.size();
+    }
+
+    return std::fclose(file) == 0 && ok;
+}
+
+MobilityTraceReader::MobilityTraceReader() :
+    mapping(nullptr),
+    mappingSize(0),
+    header(nullptr),
+    vehicles(nullptr),
+    samples(nullptr)
+{
+}
+
+MobilityTraceReader::~MobilityTraceReader()
+{
+    close();
+}
+
+bool MobilityTraceReader::open(const std::string& path)
+{
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(MobilityTraceHeader)) {
+        ::close(fd);
+        return false;
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    size_t size = static_cast<size_t>(info.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    mapping = data;
+    mappingSize = size;
+
+    const MobilityTraceHeader* candidate = static_cast<const MobilityTraceHeader*>(data);
+    size_t tableEnd = sizeof(MobilityTraceHeader) + candidate->numVehicles * sizeof(MobilityTraceVehicle);
+    bool ok = std::memcmp(candidate->magic, "NRMT", 4) == 0 &&
+              candidate->version == FILE_VERSION &&
+              candidate->sampleSize == sizeof(MobilityTraceSample) &&
+              candidate->vehicleSize == sizeof(MobilityTraceVehicle) &&
+              candidate->stepLength > 0 &&
+              tableEnd + candidate->numSamples * sizeof(MobilityTraceSample) <= size;
+    if (!ok) {
+        close();
+        return false;
+    }
+
+    // Each vehicle's samples are read front to back
+    madvise(data, size, MADV_SEQUENTIAL);
+    const char* base = static_cast<const char*>(data);
+    header = candidate;
+    vehicles = reinterpret_cast<const MobilityTraceVehicle*>(base + sizeof(MobilityTraceHeader));
+    samples = reinterpret_cast<const MobilityTraceSample*>(base + tableEnd);
+    return true;
+}
+
+void MobilityTraceReader::close()
+{
+    if (mapping) {
+        munmap(mapping, mappingSize);
+    }
+    mapping = nullptr;
+    mappingSize = 0;
+    header = nullptr;
+    vehicles = nullptr;
+    samples = nullptr;
+}
+
+const MobilityTraceVehicle* MobilityTraceReader::findVehicle(int index) const
+{
+    const MobilityTraceVehicle* end = vehicles + header->numVehicles;
+    const MobilityTraceVehicle* found = std::lower_bound(vehicles, end, index,
+        [](const MobilityTraceVehicle& vehicle, int value) { return vehicle.index < value; });
+    return found != end && found->index == index ? found : nullptr;
+}
+
+std::shared_ptr<const MobilityTraceReader> MobilityTraceReader::openShared(const std::string& path)
+{
+    static std::mutex lock;
+    static std::map<std::string, std::weak_ptr<const MobilityTraceReader>> readers;
+
+    std::lock_guard<std::mutex> guard(lock);
+    std::shared_ptr<const MobilityTraceReader> reader = readers[path].lock();
+    if (!reader) {
+        std::shared_ptr<MobilityTraceReader> opened = std::make_shared<MobilityTraceReader>();
+        if (!opened->open(path)) {
+            return nullptr;
+        }
+        reader = opened;
+        readers[path] = reader;
+    }
+    return reader;
+}
+
+}  // namespace nr
@@ -0,0 +1,130 @@
+#ifndef __MOBILITY_TRACE_H
+#define __MOBILITY_TRACE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace nr {
+
+/**
+ * @brief Header at the start of a mobility trace file
+ *
+ * The header is followed by numVehicles MobilityTraceVehicle entries,
+ * sorted by index, and then by the samples of all vehicles. The samples
+ * of one vehicle are contiguous, one per step of its lifetime.
+ */
+struct MobilityTraceHeader {
+    char magic[4];           ///< "NRMT"
+    uint32_t version;
+    uint32_t sampleSize;     ///< sizeof(MobilityTraceSample) of the writer
+    uint32_t vehicleSize;    ///< sizeof(MobilityTraceVehicle) of the writer
+    double stepLength;       ///< Time between samples in s
+    uint32_t numVehicles;
+    uint32_t reserved;
+    uint64_t numSamples;     ///< Samples of all vehicles
+};
+
+/**
+ * @brief Lifetime of one vehicle and the location of its samples
+ */
+struct MobilityTraceVehicle {
+    int32_t index;           ///< Index of the vehicle in its module vector
+    int32_t firstStep;       ///< Step the vehicle appeared in
+    int32_t numSteps;        ///< Steps the vehicle lived, one sample each
+    uint32_t reserved;
+    uint64_t firstSample;    ///< Position of the first sample in the sample array
+};
+
+/**
+ * @brief State of one vehicle in one step
+ */
+struct MobilityTraceSample {
+    float x;                 ///< Position in m
+    float y;
+    float speed;             ///< Speed in m/s
+    float heading;           ///< Direction of travel in rad, counter-clockwise from the x axis
+};
+
+/**
+ * @brief Collects vehicle states during a run and writes them as a trace
+ *
+ * Samples are kept per vehicle in memory and written in one go, vehicle
+ * by vehicle, so that a replay streams each vehicle's samples
+ * sequentially. Steps without a sample repeat the previous one; several
+ * samples in the same step keep the last.
+ */
+class MobilityTraceWriter
+{
+  public:
+    explicit MobilityTraceWriter(double stepLength);
+
+    void add(int index, int64_t step, const MobilityTraceSample& sample);
+    bool write(const std::string& path) const;
+
+    size_t getNumVehicles() const { return tracks.size(); }
+    uint64_t getNumSamples() const { return numSamples; }
+
+  private:
+    struct Track {
+        int64_t firstStep;
+        std::vector<MobilityTraceSample> samples;
+    };
+
+    double stepLength;
+    std::map<int, Track> tracks;  ///< Keyed by vehicle index, written in that order
+    uint64_t numSamples;
+};
+
+/**
+ * @brief Read-only, memory-mapped view of a mobility trace file
+ *
+ * The file is mapped once per process and shared by all replaying
+ * vehicles through openShared(); samples are read straight from the
+ * mapping, so a replay costs page faults instead of parsing or IPC.
+ *
+ * This header does not depend on OMNeT++ so that the tools can use it.
+ */
+class MobilityTraceReader
+{
+  public:
+    MobilityTraceReader();
+    ~MobilityTraceReader();
+    MobilityTraceReader(const MobilityTraceReader&) = delete;
+    MobilityTraceReader& operator=(const MobilityTraceReader&) = delete;
+
+    // Lifetime
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    // Trace access
+    double getStepLength() const { return header->stepLength; }
+    uint32_t getNumVehicles() const { return header->numVehicles; }
+    uint64_t getNumSamples() const { return header->numSamples; }
+    const MobilityTraceVehicle& getVehicle(uint32_t i) const { return vehicles[i]; }
+    const MobilityTraceVehicle* findVehicle(int index) const;
+    const MobilityTraceSample* getSamples(const MobilityTraceVehicle& vehicle) const {
+        return samples + vehicle.firstSample;
+    }
+
+    // Process-wide reader per path, opened on first use; null if the file is unusable
+    static std::shared_ptr<const MobilityTraceReader> openShared(const std::string& path);
+
+  private:
+    void* mapping;
+    size_t mappingSize;
+    const MobilityTraceHeader* header;
+    const MobilityTraceVehicle* vehicles;
+    const MobilityTraceSample* samples;
+
+    static const uint32_t FILE_VERSION = 1;
+    friend class MobilityTraceWriter;
+};
+
+}  // namespace nr
+
+#endif // __MOBILITY_TRACE_H
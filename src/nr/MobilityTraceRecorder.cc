@@ -0,0 +1,83 @@
+#include "MobilityTraceRecorder.h"
+#include <inet/common/ModuleAccess.h>
+#include <inet/mobility/contract/IMobility.h>
+#include <cmath>
+
+namespace nr {
+
+Define_Module(MobilityTraceRecorder);
+
+MobilityTraceRecorder::MobilityTraceRecorder() :
+    stepLength(0),
+    writer(nullptr),
+    totalUpdates(0)
+{
+}
+
+MobilityTraceRecorder::~MobilityTraceRecorder()
+{
+    delete writer;
+}
+
+void MobilityTraceRecorder::initialize()
+{
+    traceFile = par("traceFile").stringValue();
+    stepLength = par("stepLength").doubleValue();
+    if (traceFile.empty()) {
+        throw cRuntimeError("MobilityTraceRecorder needs a traceFile");
+    }
+    if (stepLength <= 0) {
+        throw cRuntimeError("Invalid step length %f", stepLength);
+    }
+    
+    writer = new MobilityTraceWriter(stepLength);
+    getSimulation()->getSystemModule()->subscribe(inet::IMobility::mobilityStateChangedSignal, this);
+    
+    WATCH(totalUpdates);
+}
+
+void MobilityTraceRecorder::handleMessage(cMessage *)
+{
+    throw cRuntimeError("MobilityTraceRecorder does not process messages");
+}
+
+void MobilityTraceRecorder::finish()
+{
+    getSimulation()->getSystemModule()->unsubscribe(inet::IMobility::mobilityStateChangedSignal, this);
+    
+    recordScalar("mobilityUpdates", totalUpdates);
+    recordScalar("tracedVehicles", writer->getNumVehicles());
+    recordScalar("tracedSamples", writer->getNumSamples());
+    if (!writer->write(traceFile)) {
+        throw cRuntimeError("Could not write mobility trace %s", traceFile.c_str());
+    }
+    EV_INFO << "Mobility trace of " << writer->getNumVehicles() << " vehicles written to " << traceFile << endl;
+}
+
+void MobilityTraceRecorder::receiveSignal(cComponent *source, simsignal_t, cObject *obj, cObject *)
+{
+    inet::IMobility* mobility = dynamic_cast<inet::IMobility*>(obj);
+    cModule* node = inet::findContainingNode(check_and_cast<cModule*>(source));
+    if (!mobility || !node) {
+        return;
+    }
+    
+    // Only vehicles in a module vector can be matched up again on replay
+    if (!node->isVector()) {
+        return;
+    }
+    
+    inet::Coord position = mobility->getCurrentPosition();
+    inet::Coord velocity = mobility->getCurrentVelocity();
+    MobilityTraceSample sample;
+    sample.x = static_cast<float>(position.x);
+    sample.y = static_cast<float>(position.y);
+    sample.speed = static_cast<float>(std::sqrt(velocity.x * velocity.x + velocity.y * velocity.y));
+    sample.heading = static_cast<float>(std::atan2(velocity.y, velocity.x));
+    
+    int64_t step = static_cast<int64_t>(std::floor(SIMTIME_DBL(simTime()) / stepLength + 1e-9));
+    writer->add(node->getIndex(), step, sample);
+    totalUpdates++;
+}
+
+}  // namespace nr
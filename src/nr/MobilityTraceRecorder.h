@@ -0,0 +1,53 @@
+#ifndef __MOBILITY_TRACE_RECORDER_H
+#define __MOBILITY_TRACE_RECORDER_H
+
+#include <omnetpp.h>
+#include <inet/common/INETDefs.h>
+#include <string>
+
+#include "MobilityTrace.h"
+
+using namespace omnetpp;
+
+namespace nr {
+
+/**
+ * @brief Records the mobility of all vehicles into a binary trace
+ *
+ * Listens at the network level to the mobility state changes of every
+ * node, whatever mobility model drives it (usually SUMO through TraCI),
+ * and keeps one sample per vehicle and step: position, speed and heading.
+ * Vehicles are identified by their index in their module vector, and
+ * their lifetime runs from the first to the last step they reported in.
+ * The trace is written when the run finishes and is replayed without SUMO
+ * by TraceReplayMobility.
+ */
+class MobilityTraceRecorder : public cSimpleModule, public cListener
+{
+  protected:
+    // Configuration parameters
+    std::string traceFile;
+    double stepLength;           ///< Sampling step in s
+    
+    MobilityTraceWriter* writer;
+    
+    // Statistics
+    long totalUpdates;
+    
+  protected:
+    // OMNeT++ module interface
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+    
+  public:
+    MobilityTraceRecorder();
+    virtual ~MobilityTraceRecorder();
+    
+    // Mobility state changes of all nodes
+    virtual void receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj, cObject *details) override;
+};
+
+}  // namespace nr
+
+#endif // __MOBILITY_TRACE_RECORDER_H
@@ -0,0 +1,72 @@
+#include "ModeHistory.h"
+#include <stdexcept>
+
+namespace nr {
+
+ModeHistory::ModeHistory(size_t capacity) :
+    entries(capacity),
+    head(0),
+    count(0),
+    currentMode(0),
+    modeSince(0),
+    totalTransitions(0)
+{
+    if (capacity == 0) {
+        throw std::invalid_argument("ModeHistory: capacity must be positive");
+    }
+    start(0, 0);
+}
+
+void ModeHistory::start(int initialMode, simtime_t now)
+{
+    if (!isValidMode(initialMode)) {
+        throw std::invalid_argument("ModeHistory: invalid mode");
+    }
+
+    head = 0;
+    count = 0;
+    currentMode = initialMode;
+    modeSince = now;
+    for (int from = 0; from < NUM_MODES; from++) {
+        timeInMode[from] = 0;
+        for (int to = 0; to < NUM_MODES; to++) {
+            transitions[from][to] = 0;
+        }
+    }
+    totalTransitions = 0;
+}
+
+void ModeHistory::record(int newMode, simtime_t now)
+{
+    if (!isValidMode(newMode)) {
+        throw std::invalid_argument("ModeHistory: invalid mode");
+    }
+
+    // Close the residency interval of the mode being left
+    timeInMode[currentMode] += now - modeSince;
+    transitions[currentMode][newMode]++;
+    totalTransitions++;
+    currentMode = newMode;
+    modeSince = now;
+
+    // Overwrite the oldest entry once the ring is full
+    if (count < entries.size()) {
+        entries[(head + count) % entries.size()] = Entry{now, newMode};
+        count++;
+    }
+    else {
+        entries[head] = Entry{now, newMode};
+        head = (head + 1) % entries.size();
+    }
+}
+
+simtime_t ModeHistory::getTimeInMode(int mode, simtime_t now) const
+{
+    if (!isValidMode(mode)) {
+        return 0;
+    }
+    // The current interval is still open
+    return mode == currentMode ? timeInMode[mode] + (now - modeSince) : timeInMode[mode];
+}
+
+}  // namespace nr
\ No newline at end of file
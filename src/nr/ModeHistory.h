@@ -0,0 +1,67 @@
+#ifndef __MODE_HISTORY_H
+#define __MODE_HISTORY_H
+
+#include <omnetpp.h>
+#include <cstddef>
+#include <vector>
+
+using namespace omnetpp;
+
+namespace nr {
+
+/**
+ * @brief Bounded history of mode switches with running residency statistics
+ *
+ * The most recent switches are kept in a fixed-capacity ring, so recording
+ * one never moves the older entries. Time spent in each mode and a
+ * from/to transition count matrix are updated in O(1) per switch, which
+ * lets every UE report residency without keeping its full history.
+ * Modes are identified by their index (static_cast<int>(V2XMode)).
+ */
+class ModeHistory
+{
+  public:
+    static const int NUM_MODES = 4;
+
+    struct Entry {
+        simtime_t time;      ///< Time of the switch
+        int mode;            ///< Mode switched to
+    };
+
+    explicit ModeHistory(size_t capacity);
+
+    // Recording
+    void start(int initialMode, simtime_t now);
+    void record(int newMode, simtime_t now);
+
+    // Recent switches, index 0 is the oldest kept
+    size_t size() const { return count; }
+    size_t capacity() const { return entries.size(); }
+    size_t getMemoryFootprint() const { return entries.capacity() * sizeof(Entry); }
+    bool empty() const { return count == 0; }
+    const Entry& at(size_t index) const { return entries[(head + index) % entries.size()]; }
+    const Entry& latest() const { return at(count - 1); }
+
+    // Residency and transitions since start()
+    int getCurrentMode() const { return currentMode; }
+    simtime_t getTimeInMode(int mode, simtime_t now) const;
+    long getTransitionCount(int fromMode, int toMode) const { return transitions[fromMode][toMode]; }
+    long getTotalTransitions() const { return totalTransitions; }
+
+  private:
+    std::vector<Entry> entries;
+    size_t head;             ///< Position of the oldest entry
+    size_t count;            ///< Number of valid entries
+
+    int currentMode;
+    simtime_t modeSince;     ///< Start of the current residency interval
+    simtime_t timeInMode[NUM_MODES];   ///< Closed residency intervals only
+    long transitions[NUM_MODES][NUM_MODES];
+    long totalTransitions;
+
+    static bool isValidMode(int mode) { return mode >= 0 && mode < NUM_MODES; }
+};
+
+}  // namespace nr
+
+#endif // __MODE_HISTORY_H
\ No newline at end of file
@@ -8,27 +8,32 @@ namespace nr {
 // Define static constants
 const simtime_t ModeSwitchController::MIN_SWITCH_INTERVAL = 1.0;  // 1 second
 const double ModeSwitchController::DEFAULT_RSRP_THRESHOLD = -110.0;  // dBm
+const double ModeSwitchController::DEFAULT_EWMA_ALPHA = 0.1;
 
 ModeSwitchController::ModeSwitchController(NRModule* parent) :
     parentModule(parent),
     currentMode(V2XMode::MODE_2),  // Start in autonomous mode
     lastSwitchTime(0),
-    lastEvaluationTime(0),
+    triggerArmed(false),
+    triggerTarget(V2XMode::MODE_2),
+    triggerExpiry(-1),
+    triggersCancelled(0),
+    refusedTarget(-1),
+    enabledModes(ALL_MODES),
     totalSwitches(0),
+    modeHistory(MAX_HISTORY_SIZE),
     currentRSRP(0)
 {
     if (!parent) {
         throw std::runtime_error("ModeSwitchController: Parent module cannot be null");
     }
     
-    // Initialize enabled modes
-    enabledModes[V2XMode::MODE_1] = true;
-    enabledModes[V2XMode::MODE_2] = true;
-    enabledModes[V2XMode::MODE_3] = true;
-    enabledModes[V2XMode::MODE_4] = true;
+    // Residency is counted from the moment the controller starts
+    modeHistory.start(static_cast<int>(currentMode), simTime());
     
     // Initialize metrics
     initializeMetrics();
+    configureEstimators(DEFAULT_EWMA_ALPHA, DEFAULT_L3_FILTER_COEFFICIENT, DEFAULT_QUANTILE_WINDOW);
 }
 
 ModeSwitchController::~ModeSwitchController()
@@ -36,35 +41,28 @@ ModeSwitchController::~ModeSwitchController()
     // Cleanup if needed
 }
 
-bool ModeSwitchController::evaluateSwitch()
+ModeSwitchController* ModeSwitchController::create(const std::string& policy, NRModule* parent)
+{
+    if (policy == DefaultSwitchPolicy::name()) {
+        return new ModeSwitchControllerImpl<DefaultSwitchPolicy>(parent);
+    }
+    if (policy == ConservativeSwitchPolicy::name()) {
+        return new ModeSwitchControllerImpl<ConservativeSwitchPolicy>(parent);
+    }
+    if (policy == SemiPersistentSwitchPolicy::name()) {
+        return new ModeSwitchControllerImpl<SemiPersistentSwitchPolicy>(parent);
+    }
+    if (policy == SensingFirstSwitchPolicy::name()) {
+        return new ModeSwitchControllerImpl<SensingFirstSwitchPolicy>(parent);
+    }
+    throw std::invalid_argument("Unknown mode switch policy '" + policy + "'");
+}
+
+template<typename Policy>
+bool ModeSwitchControllerImpl<Policy>::evaluateSwitch()
 {
     try {
-        // Update current metrics
-        collectPerformanceMetrics();
-        
-        // Check if we're in a stable state and enough time has passed
-        if (!isStableState() || hasRecentlySwitched()) {
-            return false;
-        }
-        
-        // Evaluate network conditions
-        double networkQuality = measureNetworkQuality();
-        bool rsrpCondition = checkRSRPCondition();
-        bool resourceCondition = checkResourceAvailability();
-        
-        // Determine if switch is needed based on conditions
-        if (rsrpCondition && resourceCondition) {
-            V2XMode targetMode = static_cast<V2XMode>(determineTargetMode());
-            
-            if (targetMode != currentMode && validateModeTransition(targetMode)) {
-                EV_INFO << "Mode switch evaluation suggests switching to mode " 
-                       << static_cast<int>(targetMode) << endl;
-                return true;
-            }
-        }
-        
-        lastEvaluationTime = simTime();
-        return false;
+        return enteringTarget() >= 0;
     }
     catch (const std::exception& e) {
         handleSwitchError(e.what());
@@ -72,8 +70,32 @@ bool ModeSwitchController::evaluateSwitch()
     }
 }
 
-bool ModeSwitchController::executeSwitch(int newMode)
+template<typename Policy>
+int ModeSwitchControllerImpl<Policy>::enteringTarget() const
+{
+    // Evaluate network conditions
+    if (!checkRSRPCondition() || !checkResourceAvailability()) {
+        return -1;
+    }
+    
+    // Only a different mode the policy may move to, and would accept, counts as entering
+    ModeSwitchContext context = makeContext();
+    V2XMode targetMode = Policy::targetMode(context);
+    if (targetMode == currentMode || !isModeEnabled(targetMode) ||
+        !isValidTransition(currentMode, targetMode) || !Policy::meetsRequirements(targetMode, context)) {
+        return -1;
+    }
+    return static_cast<int>(targetMode);
+}
+
+template<typename Policy>
+bool ModeSwitchControllerImpl<Policy>::executeSwitch(int newMode)
 {
+    if (newMode < 0 || newMode >= NUM_V2X_MODES) {
+        EV_WARN << "Invalid mode " << newMode << endl;
+        return false;
+    }
+    
     try {
         V2XMode targetMode = static_cast<V2XMode>(newMode);
         
@@ -88,16 +110,20 @@ bool ModeSwitchController::executeSwitch(int newMode)
         V2XMode oldMode = currentMode;
         
         // Perform the switch
-        if (meetsTransitionRequirements(targetMode)) {
+        if (Policy::meetsRequirements(targetMode, makeContext())) {
             currentMode = targetMode;
             lastSwitchTime = simTime();
             totalSwitches++;
+            refusedTarget = -1;
             
             // Update history
             updateModeHistory(targetMode);
             
             // Log success
             onModeSwitchSuccess(oldMode, targetMode);
+            
+            // The new mode may already meet the condition for another switch
+            updateTrigger();
             return true;
         }
         else {
@@ -111,67 +137,193 @@ bool ModeSwitchController::executeSwitch(int newMode)
     }
 }
 
-int ModeSwitchController::determineTargetMode()
+template<typename Policy>
+int ModeSwitchControllerImpl<Policy>::determineTargetMode()
 {
-    // Collect current performance metrics
-    collectPerformanceMetrics();
-    
-    // Decision logic based on network conditions and performance
-    if (currentRSRP > switchParams.rsrpThreshold + switchParams.hysteresis) {
-        // Good network conditions - prefer network scheduled mode
-        return static_cast<int>(V2XMode::MODE_1);
-    }
-    else if (currentMetrics.resourceUtilization > 0.8) {
-        // High resource utilization - consider semi-persistent scheduling
-        return static_cast<int>(V2XMode::MODE_3);
+    // Decision logic on the metrics cached by the estimators
+    return static_cast<int>(Policy::targetMode(makeContext()));
+}
+
+template<typename Policy>
+bool ModeSwitchControllerImpl<Policy>::validateModeTransition(V2XMode targetMode) const
+{
+    // Check if target mode is enabled
+    if (!isModeEnabled(targetMode)) {
+        EV_WARN << "Target mode " << static_cast<int>(targetMode) << " is not enabled" << endl;
+        return false;
     }
-    else if (currentRSRP < switchParams.rsrpThreshold - switchParams.hysteresis) {
-        // Poor network conditions - use autonomous mode
-        return static_cast<int>(V2XMode::MODE_2);
+    
+    // Check if transition is valid
+    if (!isValidTransition(currentMode, targetMode)) {
+        EV_WARN << "Invalid transition from mode " << static_cast<int>(currentMode)
+                << " to mode " << static_cast<int>(targetMode) << endl;
+        return false;
     }
     
-    // Default to current mode if no clear decision
-    return static_cast<int>(currentMode);
+    return true;
+}
+
+template<typename Policy>
+bool ModeSwitchControllerImpl<Policy>::isValidTransition(V2XMode from, V2XMode to) const
+{
+    // Both modes enabled and the pair allowed by the policy's table
+    return isModeEnabled(from) && isModeEnabled(to) && Policy::transitions().allows(from, to);
 }
 
+// The policies selectable through create()
+template class ModeSwitchControllerImpl<DefaultSwitchPolicy>;
+template class ModeSwitchControllerImpl<ConservativeSwitchPolicy>;
+template class ModeSwitchControllerImpl<SemiPersistentSwitchPolicy>;
+template class ModeSwitchControllerImpl<SensingFirstSwitchPolicy>;
+
 void ModeSwitchController::setParameters(const ModeSwitchParams& params)
 {
+    // Rejected parameters leave the previous ones in place
+    ModeSwitchParams previous = switchParams;
     switchParams = params;
-    validateParameters();
+    try {
+        validateParameters();
+    }
+    catch (...) {
+        switchParams = previous;
+        throw;
+    }
 }
 
 void ModeSwitchController::enableMode(V2XMode mode, bool enabled)
 {
-    enabledModes[mode] = enabled;
+    if (enabled) {
+        enabledModes |= modeBit(mode);
+    }
+    else {
+        enabledModes &= static_cast<uint8_t>(~modeBit(mode));
+    }
 }
 
-bool ModeSwitchController::isModeEnabled(V2XMode mode) const
+void ModeSwitchController::configureEstimators(double ewmaAlpha, int l3FilterCoefficient, size_t quantileWindow)
 {
-    auto it = enabledModes.find(mode);
-    return it != enabledModes.end() && it->second;
+    estimators.pdr.setAlpha(ewmaAlpha);
+    estimators.latency.setAlpha(ewmaAlpha);
+    estimators.utilization.setAlpha(ewmaAlpha);
+    estimators.rsrp.setAlpha(EwmaEstimator::l3FilterAlpha(l3FilterCoefficient));
+    
+    // 0.5 ms latency buckets up to 100 ms, 0.5% utilization buckets, 0.5 dB RSRP buckets
+    estimators.latencyWindow.configure(quantileWindow, 0.0, 100.0, 200);
+    estimators.utilizationWindow.configure(quantileWindow, 0.0, 1.0, 200);
+    estimators.rsrpWindow.configure(quantileWindow, -140.0, -40.0, 200);
 }
 
-bool ModeSwitchController::validateModeTransition(V2XMode targetMode) const
+void ModeSwitchController::recordDelivery(bool delivered)
 {
-    // Check if target mode is enabled
-    if (!isModeEnabled(targetMode)) {
-        EV_WARN << "Target mode " << static_cast<int>(targetMode) << " is not enabled" << endl;
-        return false;
+    estimators.pdr.add(delivered ? 1.0 : 0.0);
+    currentMetrics.packetDeliveryRatio = estimators.pdr.getValue();
+    updateTrigger();
+}
+
+void ModeSwitchController::recordLatency(simtime_t latency)
+{
+    double ms = SIMTIME_DBL(latency) * 1000.0;
+    estimators.latency.add(ms);
+    estimators.latencyWindow.add(ms);
+    currentMetrics.latency = estimators.latency.getValue();
+    updateTrigger();
+}
+
+void ModeSwitchController::recordUtilization(double utilization, long slots)
+{
+    // One sample per slot, so the estimates do not depend on which slots were ticked
+    estimators.utilization.add(utilization, slots);
+    estimators.utilizationWindow.add(utilization, slots);
+    currentMetrics.resourceUtilization = estimators.utilization.getValue();
+    updateTrigger();
+}
+
+void ModeSwitchController::recordRsrp(double rsrpDbm)
+{
+    estimators.rsrp.add(rsrpDbm);
+    currentRSRP = estimators.rsrp.getValue();
+    estimators.rsrpWindow.add(currentRSRP);
+    updateTrigger();
+}
+
+void ModeSwitchController::updateTrigger()
+{
+    int target = enteringTarget();
+    if (target >= 0 && target == refusedTarget) {
+        return;  // Unchanged since the refusal, wait for the condition to move
+    }
+    refusedTarget = -1;
+    if (target < 0) {
+        // Crossed back before expiry
+        if (triggerArmed) {
+            triggersCancelled++;
+            disarmTrigger();
+        }
+        return;
     }
     
-    // Check if transition is valid
-    if (!isValidTransition(currentMode, targetMode)) {
-        EV_WARN << "Invalid transition from mode " << static_cast<int>(currentMode)
-                << " to mode " << static_cast<int>(targetMode) << endl;
-        return false;
+    V2XMode targetMode = static_cast<V2XMode>(target);
+    if (triggerArmed && targetMode == triggerTarget) {
+        return;  // Already counting down towards this mode
+    }
+    if (triggerArmed) {
+        triggersCancelled++;  // A different target restarts the count
     }
     
-    return true;
+    // Never expire within the minimum interval after the last switch
+    triggerArmed = true;
+    triggerTarget = targetMode;
+    triggerExpiry = std::max(simTime() + switchParams.timeToTrigger, lastSwitchTime + MIN_SWITCH_INTERVAL);
+    parentModule->scheduleTimeToTrigger(triggerExpiry);
+    EV_DETAIL << "Time to trigger armed for mode " << target << ", expires at " << triggerExpiry << endl;
+}
+
+int ModeSwitchController::onTriggerExpired()
+{
+    if (!triggerArmed) {
+        return -1;
+    }
+    
+    // A crossing back would have cancelled the event, so the condition held throughout
+    triggerArmed = false;
+    triggerExpiry = -1;
+    return static_cast<int>(triggerTarget);
+}
+
+void ModeSwitchController::onSwitchRefused(int mode)
+{
+    refusedTarget = mode;
+}
+
+void ModeSwitchController::disarmTrigger()
+{
+    triggerArmed = false;
+    triggerExpiry = -1;
+    parentModule->scheduleTimeToTrigger(-1);
+}
+
+size_t ModeSwitchController::getMemoryFootprint() const
+{
+    // The policy instantiations add no members
+    size_t bytes = sizeof(*this);
+    bytes += modeHistory.getMemoryFootprint();
+    bytes += estimators.latencyWindow.getMemoryFootprint();
+    bytes += estimators.utilizationWindow.getMemoryFootprint();
+    bytes += estimators.rsrpWindow.getMemoryFootprint();
+    return bytes;
+}
+
+ModeSwitchContext ModeSwitchController::makeContext() const
+{
+    return ModeSwitchContext{currentMode, currentRSRP, currentMetrics.packetDeliveryRatio,
+                             currentMetrics.latency, currentMetrics.resourceUtilization, switchParams};
 }
 
 bool ModeSwitchController::checkRSRPCondition() const
 {
-    return std::abs(currentRSRP - switchParams.rsrpThreshold) > switchParams.hysteresis;
+    // No decision on RSRP before the first measurement
+    return estimators.rsrp.hasValue() &&
+           std::abs(currentRSRP - switchParams.rsrpThreshold) > switchParams.hysteresis;
 }
 
 bool ModeSwitchController::checkResourceAvailability() const
@@ -182,12 +334,8 @@ bool ModeSwitchController::checkResourceAvailability() const
 
 void ModeSwitchController::updateModeHistory(V2XMode newMode)
 {
-    modeHistory.push_back(std::make_pair(simTime(), newMode));
-    
-    // Keep history size bounded
-    if (modeHistory.size() > MAX_HISTORY_SIZE) {
-        modeHistory.erase(modeHistory.begin());
-    }
+    // Bounded ring, the oldest entry is overwritten once it is full
+    modeHistory.record(static_cast<int>(newMode), simTime());
 }
 
 double ModeSwitchController::measureNetworkQuality() const
@@ -201,20 +349,6 @@ double ModeSwitchController::measureNetworkQuality() const
     return quality;
 }
 
-void ModeSwitchController::collectPerformanceMetrics()
-{
-    // Update metrics from parent module
-    if (parentModule) {
-        // These would be actual measurements in a real implementation
-        currentMetrics.packetDeliveryRatio = 0.95;  // Example value
-        currentMetrics.latency = 20.0;              // Example value (ms)
-        currentMetrics.resourceUtilization = 0.7;   // Example value
-        
-        // Update RSRP measurement
-        currentRSRP = -105.0;  // Example value (dBm)
-    }
-}
-
 bool ModeSwitchController::evaluatePerformanceThresholds() const
 {
     return currentMetrics.packetDeliveryRatio > 0.9 &&
@@ -236,16 +370,6 @@ void ModeSwitchController::onModeSwitchFailure(V2XMode targetMode, const char* r
     logModeTransition(currentMode, targetMode, false);
 }
 
-bool ModeSwitchController::isStableState() const
-{
-    return (simTime() - lastEvaluationTime) >= switchParams.timeToTrigger;
-}
-
-bool ModeSwitchController::hasRecentlySwitched() const
-{
-    return (simTime() - lastSwitchTime) < MIN_SWITCH_INTERVAL;
-}
-
 void ModeSwitchController::validateParameters() const
 {
     if (switchParams.rsrpThreshold > -70 || switchParams.rsrpThreshold < -140) {
@@ -256,7 +380,8 @@ void ModeSwitchController::validateParameters() const
         throw std::runtime_error("Invalid hysteresis value");
     }
     
-    if (switchParams.timeToTrigger < 0) {
+    // A zero time to trigger would re-arm and expire at the same instant
+    if (switchParams.timeToTrigger <= 0) {
         throw std::runtime_error("Invalid time to trigger value");
     }
 }
@@ -281,32 +406,4 @@ void ModeSwitchController::logModeTransition(V2XMode oldMode, V2XMode newMode, b
             << " at time " << simTime() << endl;
 }
 
-bool ModeSwitchController::isValidTransition(V2XMode from, V2XMode to) const
-{
-    // Define valid transitions
-    // In this implementation, all transitions are allowed between enabled modes
-    return isModeEnabled(from) && isModeEnabled(to);
-}
-
-bool ModeSwitchController::meetsTransitionRequirements(V2XMode targetMode) const
-{
-    // Check specific requirements for each target mode
-    switch (targetMode) {
-        case V2XMode::MODE_1:
-            return currentRSRP > switchParams.rsrpThreshold;
-            
-        case V2XMode::MODE_2:
-            return true;  // Always allowed as fallback
-            
-        case V2XMode::MODE_3:
-            return currentMetrics.resourceUtilization < 0.8;
-            
-        case V2XMode::MODE_4:
-            return currentMetrics.packetDeliveryRatio > 0.8;
-            
-        default:
-            return false;
-    }
-}
-
 }  // namespace nr
\ No newline at end of file
@@ -2,8 +2,12 @@
 #define __MODE_SWITCH_CONTROLLER_H
 
 #include <omnetpp.h>
-#include <vector>
-#include <map>
+#include <cstdint>
+#include <string>
+
+#include "MetricEstimators.h"
+#include "ModeHistory.h"
+#include "ModeSwitchPolicy.h"
 
 using namespace omnetpp;
 
@@ -11,90 +15,121 @@ namespace nr {
 
 class NRModule;  // Forward declaration
 
-/**
- * @brief Enumeration of V2X operation modes
- */
-enum class V2XMode {
-    MODE_1,        ///< Network scheduled mode
-    MODE_2,        ///< Autonomous mode
-    MODE_3,        ///< Semi-persistent scheduling
-    MODE_4         ///< Sensing-based semi-persistent scheduling
-};
-
-/**
- * @brief Structure to hold mode switching parameters
- */
-struct ModeSwitchParams {
-    double rsrpThreshold;      ///< RSRP threshold for mode switching (dBm)
-    double hysteresis;         ///< Hysteresis margin (dB)
-    simtime_t timeToTrigger;   ///< Time to trigger switching (s)
-    
-    ModeSwitchParams() :
-        rsrpThreshold(-110.0),  // Default values
-        hysteresis(3.0),
-        timeToTrigger(1.0) {}
-};
-
 /**
  * @brief Controller class for V2X mode switching decisions
  *
  * Handles the logic for switching between different V2X operation modes
  * based on network conditions, resource availability, and configured thresholds.
+ * The decision logic comes from a switching policy (see ModeSwitchPolicy.h)
+ * compiled into ModeSwitchControllerImpl; create() picks the instantiation
+ * by policy name, so each operation costs one virtual call and the policy
+ * code inside it is called directly.
+ *
+ * Link metrics are tracked by streaming estimators fed from allocation
+ * and reception events (record*()); each sample updates the cached values
+ * in O(1), so an evaluation only reads them.
+ *
+ * Time to trigger is event driven: every sample re-checks the entering
+ * condition, and the first time it holds the parent module arms a single
+ * expiry event timeToTrigger later. Leaving the condition (or a change
+ * of target mode) cancels it, and the switch is made when it expires.
+ * A refused switch is not re-armed until a later sample changes the
+ * entering condition.
  */
 class ModeSwitchController
 {
   public:
-    // Constructor and destructor
-    ModeSwitchController(NRModule* parent);
+    // Factory and destructor
+    static ModeSwitchController* create(const std::string& policy, NRModule* parent);
     virtual ~ModeSwitchController();
     
     // Mode switching interface
-    bool evaluateSwitch();
-    bool executeSwitch(int newMode);
-    int determineTargetMode();
+    virtual bool evaluateSwitch() = 0;   ///< True while the entering condition holds
+    virtual bool executeSwitch(int newMode) = 0;
+    virtual int determineTargetMode() = 0;
+    virtual const char* getPolicyName() const = 0;
     
     // Configuration
     void setParameters(const ModeSwitchParams& params);
     void enableMode(V2XMode mode, bool enabled);
+    void configureEstimators(double ewmaAlpha, int l3FilterCoefficient, size_t quantileWindow);
+    
+    // Measurement input
+    void recordDelivery(bool delivered);
+    void recordLatency(simtime_t latency);
+    void recordUtilization(double utilization, long slots = 1);
+    void recordRsrp(double rsrpDbm);
+    
+    // Time to trigger
+    void updateTrigger();
+    int onTriggerExpired();
+    void onSwitchRefused(int mode);
+    bool isTriggerArmed() const { return triggerArmed; }
+    simtime_t getTriggerExpiry() const { return triggerExpiry; }
+    long getTriggersCancelled() const { return triggersCancelled; }
     
     // Status queries
     V2XMode getCurrentMode() const { return currentMode; }
     simtime_t getLastSwitchTime() const { return lastSwitchTime; }
     int getTotalSwitches() const { return totalSwitches; }
-    bool isModeEnabled(V2XMode mode) const;
+    bool isModeEnabled(V2XMode mode) const { return (enabledModes & modeBit(mode)) != 0; }
+    const ModeHistory& getModeHistory() const { return modeHistory; }
+    size_t getMemoryFootprint() const;
+    
+    // Current estimates
+    double getPacketDeliveryRatio() const { return currentMetrics.packetDeliveryRatio; }
+    double getLatency() const { return currentMetrics.latency; }
+    double getResourceUtilization() const { return currentMetrics.resourceUtilization; }
+    double getFilteredRsrp() const { return currentRSRP; }
+    bool hasRsrpMeasurement() const { return estimators.rsrp.hasValue(); }
+    double getLatencyQuantile(double q) const { return estimators.latencyWindow.quantile(q); }
+    double getUtilizationQuantile(double q) const { return estimators.utilizationWindow.quantile(q); }
+    double getRsrpQuantile(double q) const { return estimators.rsrpWindow.quantile(q); }
     
   protected:
+    ModeSwitchController(NRModule* parent);
+    
+    /// Mode the entering condition points to, or -1 while it does not hold
+    virtual int enteringTarget() const = 0;
+    
     // Internal utility functions
-    bool validateModeTransition(V2XMode targetMode) const;
+    ModeSwitchContext makeContext() const;
     bool checkRSRPCondition() const;
     bool checkResourceAvailability() const;
     void updateModeHistory(V2XMode newMode);
     
     // Monitoring and metrics
     double measureNetworkQuality() const;
-    void collectPerformanceMetrics();
     bool evaluatePerformanceThresholds() const;
     
     // Event handling
     void onModeSwitchSuccess(V2XMode oldMode, V2XMode newMode);
     void onModeSwitchFailure(V2XMode targetMode, const char* reason);
     
-  private:
+    static uint8_t modeBit(V2XMode mode) { return static_cast<uint8_t>(1u << static_cast<int>(mode)); }
+    
+  protected:
     // Parent module reference
     NRModule* parentModule;
     
     // Current state
     V2XMode currentMode;
     simtime_t lastSwitchTime;
-    simtime_t lastEvaluationTime;
+    
+    // Time-to-trigger state
+    bool triggerArmed;              ///< Expiry event pending at the parent
+    V2XMode triggerTarget;          ///< Mode switched to when it expires
+    simtime_t triggerExpiry;
+    long triggersCancelled;         ///< Armed triggers left before expiry
+    int refusedTarget;              ///< Mode of the last refused switch, -1 when none
     
     // Configuration
     ModeSwitchParams switchParams;
-    std::map<V2XMode, bool> enabledModes;
+    uint8_t enabledModes;           ///< Bit i set when V2XMode i is enabled
     
     // Statistics and history
     int totalSwitches;
-    std::vector<std::pair<simtime_t, V2XMode>> modeHistory;
+    ModeHistory modeHistory;        ///< Recent switches plus residency and transition counts
     double currentRSRP;
     
     // Performance metrics
@@ -106,24 +141,57 @@ class ModeSwitchController
         Metrics() : packetDeliveryRatio(0), latency(0), resourceUtilization(0) {}
     } currentMetrics;
     
+    // Streaming estimators behind currentMetrics and currentRSRP
+    struct Estimators {
+        EwmaEstimator pdr;                  ///< Delivery indicator, 1 or 0 per packet
+        EwmaEstimator latency;              ///< Delivery latency in ms
+        EwmaEstimator utilization;          ///< Resource pool utilization
+        EwmaEstimator rsrp;                 ///< L3-filtered RSRP in dBm
+        WindowedQuantile latencyWindow;
+        WindowedQuantile utilizationWindow;
+        WindowedQuantile rsrpWindow;        ///< Over the filtered values
+    } estimators;
+    
     // Constants
     static const simtime_t MIN_SWITCH_INTERVAL;
     static const int MAX_HISTORY_SIZE = 100;
     static const double DEFAULT_RSRP_THRESHOLD;
+    static const double DEFAULT_EWMA_ALPHA;
+    static const int DEFAULT_L3_FILTER_COEFFICIENT = 4;
+    static const size_t DEFAULT_QUANTILE_WINDOW = 1000;
+    static const uint8_t ALL_MODES = 0x0f;
     
     // Utility functions
-    bool isStableState() const;
-    bool hasRecentlySwitched() const;
+    void disarmTrigger();
     void validateParameters() const;
     void initializeMetrics();
     
     // Error handling
     void handleSwitchError(const char* message);
     void logModeTransition(V2XMode oldMode, V2XMode newMode, bool success);
+};
+
+/**
+ * @brief Mode switch controller running a compile-time switching policy
+ */
+template<typename Policy>
+class ModeSwitchControllerImpl : public ModeSwitchController
+{
+  public:
+    explicit ModeSwitchControllerImpl(NRModule* parent) : ModeSwitchController(parent) {}
+    
+    // Mode switching interface
+    virtual bool evaluateSwitch() override;
+    virtual bool executeSwitch(int newMode) override;
+    virtual int determineTargetMode() override;
+    virtual const char* getPolicyName() const override { return Policy::name(); }
+    
+  protected:
+    virtual int enteringTarget() const override;
     
     // Mode transition validation
+    bool validateModeTransition(V2XMode targetMode) const;
     bool isValidTransition(V2XMode from, V2XMode to) const;
-    bool meetsTransitionRequirements(V2XMode targetMode) const;
 };
 
 }  // namespace nr
@@ -0,0 +1,216 @@
+#ifndef __MODE_SWITCH_POLICY_H
+#define __MODE_SWITCH_POLICY_H
+
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+namespace nr {
+
+/**
+ * @brief Enumeration of V2X operation modes
+ */
+enum class V2XMode {
+    MODE_1,        ///< Network scheduled mode
+    MODE_2,        ///< Autonomous mode
+    MODE_3,        ///< Semi-persistent scheduling
+    MODE_4         ///< Sensing-based semi-persistent scheduling
+};
+
+const int NUM_V2X_MODES = 4;  ///< Number of V2XMode values
+
+/**
+ * @brief Structure to hold mode switching parameters
+ */
+struct ModeSwitchParams {
+    double rsrpThreshold;      ///< RSRP threshold for mode switching (dBm)
+    double hysteresis;         ///< Hysteresis margin (dB)
+    simtime_t timeToTrigger;   ///< Time to trigger switching (s)
+    
+    ModeSwitchParams() :
+        rsrpThreshold(-110.0),  // Default values
+        hysteresis(3.0),
+        timeToTrigger(1.0) {}
+};
+
+/**
+ * @brief Measurements a switching policy decides on
+ */
+struct ModeSwitchContext {
+    V2XMode currentMode;
+    double rsrp;                   ///< Latest RSRP measurement (dBm)
+    double packetDeliveryRatio;
+    double latency;                ///< Latency (ms)
+    double resourceUtilization;
+    const ModeSwitchParams& params;
+};
+
+/**
+ * @brief Allowed mode transitions, indexed [from][to]
+ */
+struct ModeTransitionTable {
+    bool allowed[NUM_V2X_MODES][NUM_V2X_MODES];
+    
+    constexpr bool allows(V2XMode from, V2XMode to) const {
+        return allowed[static_cast<int>(from)][static_cast<int>(to)];
+    }
+};
+
+/*
+ * Switching policies. A policy is a stateless class with:
+ *   static const char* name();
+ *   static constexpr ModeTransitionTable transitions();
+ *   static V2XMode targetMode(const ModeSwitchContext& context);
+ *   static bool meetsRequirements(V2XMode target, const ModeSwitchContext& context);
+ * ModeSwitchControllerImpl<Policy> calls them directly, so they are
+ * inlined into the controller and the transition table folds to constants.
+ * The controller only counts down towards a target that meetsRequirements
+ * accepts; a target it rejects is never entered.
+ */
+
+/**
+ * @brief The original strategy: any transition, thresholds with hysteresis
+ *
+ * Mode 3 is targeted above 80% utilization but only admitted below it, so
+ * it is never entered; SemiPersistentSwitchPolicy admits it.
+ */
+struct DefaultSwitchPolicy {
+    static const char* name() { return "default"; }
+    
+    static constexpr ModeTransitionTable transitions() {
+        return ModeTransitionTable{{
+            {true, true, true, true},
+            {true, true, true, true},
+            {true, true, true, true},
+            {true, true, true, true}
+        }};
+    }
+    
+    static V2XMode targetMode(const ModeSwitchContext& context) {
+        const ModeSwitchParams& params = context.params;
+        if (context.rsrp > params.rsrpThreshold + params.hysteresis) {
+            return V2XMode::MODE_1;  // Good network conditions - prefer network scheduled mode
+        }
+        if (context.resourceUtilization > 0.8) {
+            return V2XMode::MODE_3;  // High resource utilization - consider semi-persistent scheduling
+        }
+        if (context.rsrp < params.rsrpThreshold - params.hysteresis) {
+            return V2XMode::MODE_2;  // Poor network conditions - use autonomous mode
+        }
+        return context.currentMode;  // No clear decision
+    }
+    
+    static bool meetsRequirements(V2XMode target, const ModeSwitchContext& context) {
+        switch (target) {
+            case V2XMode::MODE_1: return context.rsrp > context.params.rsrpThreshold;
+            case V2XMode::MODE_2: return true;  // Always allowed as fallback
+            case V2XMode::MODE_3: return context.resourceUtilization < 0.8;
+            case V2XMode::MODE_4: return context.packetDeliveryRatio > 0.8;
+        }
+        return false;
+    }
+};
+
+/**
+ * @brief Fewer, slower switches: doubled hysteresis and only neighbouring modes
+ *
+ * Network modes (1, 3) and autonomous modes (2, 4) are paired 1-2 and 3-4;
+ * everything may fall back to Mode 2.
+ */
+struct ConservativeSwitchPolicy {
+    static const char* name() { return "conservative"; }
+    
+    static constexpr ModeTransitionTable transitions() {
+        return ModeTransitionTable{{
+            {false, true,  true,  false},
+            {true,  false, false, true },
+            {false, true,  false, true },
+            {false, true,  true,  false}
+        }};
+    }
+    
+    static V2XMode targetMode(const ModeSwitchContext& context) {
+        const ModeSwitchParams& params = context.params;
+        double margin = 2 * params.hysteresis;
+        if (context.rsrp > params.rsrpThreshold + margin) {
+            return V2XMode::MODE_1;
+        }
+        if (context.resourceUtilization > 0.9) {
+            return V2XMode::MODE_3;
+        }
+        if (context.rsrp < params.rsrpThreshold - margin) {
+            return V2XMode::MODE_2;
+        }
+        return context.currentMode;
+    }
+    
+    static bool meetsRequirements(V2XMode target, const ModeSwitchContext& context) {
+        if (target == V2XMode::MODE_1) {
+            return context.rsrp > context.params.rsrpThreshold + context.params.hysteresis;
+        }
+        return DefaultSwitchPolicy::meetsRequirements(target, context);
+    }
+};
+
+/**
+ * @brief The default strategy with Mode 3 admitted while 10% of the pool is free
+ *
+ * Utilization between 80% and 90% switches to semi-persistent scheduling,
+ * which the default policy targets but never admits.
+ */
+struct SemiPersistentSwitchPolicy {
+    static const char* name() { return "semiPersistent"; }
+    
+    static constexpr ModeTransitionTable transitions() {
+        return DefaultSwitchPolicy::transitions();
+    }
+    
+    static V2XMode targetMode(const ModeSwitchContext& context) {
+        return DefaultSwitchPolicy::targetMode(context);
+    }
+    
+    static bool meetsRequirements(V2XMode target, const ModeSwitchContext& context) {
+        if (target == V2XMode::MODE_3) {
+            return context.resourceUtilization < 0.9;  // Room left to reserve
+        }
+        return DefaultSwitchPolicy::meetsRequirements(target, context);
+    }
+};
+
+/**
+ * @brief Prefers sensing-based Mode 4 whenever the UE schedules itself
+ */
+struct SensingFirstSwitchPolicy {
+    static const char* name() { return "sensingFirst"; }
+    
+    static constexpr ModeTransitionTable transitions() {
+        return ModeTransitionTable{{
+            {false, true,  true,  true },
+            {true,  false, true,  true },
+            {true,  true,  false, true },
+            {true,  true,  true,  false}
+        }};
+    }
+    
+    static V2XMode targetMode(const ModeSwitchContext& context) {
+        const ModeSwitchParams& params = context.params;
+        if (context.rsrp > params.rsrpThreshold + params.hysteresis) {
+            return V2XMode::MODE_1;
+        }
+        if (context.resourceUtilization > 0.8) {
+            return V2XMode::MODE_4;  // Sensing avoids the busiest resources
+        }
+        if (context.rsrp < params.rsrpThreshold - params.hysteresis) {
+            return context.packetDeliveryRatio > 0.8 ? V2XMode::MODE_4 : V2XMode::MODE_2;
+        }
+        return context.currentMode;
+    }
+    
+    static bool meetsRequirements(V2XMode target, const ModeSwitchContext& context) {
+        return DefaultSwitchPolicy::meetsRequirements(target, context);
+    }
+};
+
+}  // namespace nr
+
+#endif // __MODE_SWITCH_POLICY_H
\ No newline at end of file
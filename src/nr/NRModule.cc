@@ -1,7 +1,11 @@
 #include "NRModule.h"
+#include "TraceRing.h"
 #include <inet/common/ModuleAccess.h>
 #include <inet/common/lifecycle/NodeStatus.h>
 #include <simu5g/stack/phy/layer/NRPhy.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
 
 using namespace simu5g;  // Add this for NRPhy
 
@@ -14,12 +18,29 @@ NRModule::NRModule() :
     carrierFrequency(0),
     bandwidth(0),
     sidelinkEnabled(false),
+    eventDrivenAllocation(false),
     resourceManager(nullptr),
     modeSwitchController(nullptr),
+    rawSignalEmission(false),
+    statisticsWindow(0),
     isTransmitting(false),
     lastAllocationTime(0),
+    skippedAllocationSlots(0),
+    occupancyStore(nullptr),
+    mobility(nullptr),
+    receptionRange(0),
+    txPower(0),
+    sharedViewTime(-1),
+    neighborIndex(nullptr),
+    neighborIndexModuleId(-1),
+    mobilityModuleId(-1),
     resourceAllocationTimer(nullptr),
-    modeSwitchEvaluationTimer(nullptr)
+    timeToTriggerTimer(nullptr),
+    slotClock(nullptr),
+    slotClockModuleId(-1),
+    slotListenerId(-1),
+    allocationSlot(-1),
+    triggerSlot(-1)
 {
 }
 
@@ -27,7 +48,21 @@ NRModule::~NRModule()
 {
     // Clean up timers
     cancelAndDelete(resourceAllocationTimer);
-    cancelAndDelete(modeSwitchEvaluationTimer);
+    cancelAndDelete(timeToTriggerTimer);
+    
+    // Vehicles may leave before the end of the run; the clock may already be gone at teardown
+    if (slotClockModuleId >= 0) {
+        SlotClock* clock = dynamic_cast<SlotClock*>(getSimulation()->getModule(slotClockModuleId));
+        if (clock) {
+            clock->unregisterListener(slotListenerId);
+        }
+    }
+    if (neighborIndexModuleId >= 0) {
+        NeighborIndex* index = dynamic_cast<NeighborIndex*>(getSimulation()->getModule(neighborIndexModuleId));
+        if (index) {
+            index->untrack(getId(), mobilityModuleId);
+        }
+    }
     
     // Clean up managers
     delete resourceManager;
@@ -41,6 +76,7 @@ void NRModule::initialize(int stage)
         resourceAllocationSignal = registerSignal("resourceAllocation");
         modeSwitchSignal = registerSignal("modeSwitch");
         sidelinkQualitySignal = registerSignal("sidelinkQuality");
+        preemptionSignal = registerSignal("preemption");
         
         // Read configuration parameters
         try {
@@ -48,6 +84,9 @@ void NRModule::initialize(int stage)
             carrierFrequency = par("carrierFrequency").doubleValue();
             bandwidth = par("bandwidth");
             sidelinkEnabled = par("sidelinkEnabled");
+            eventDrivenAllocation = par("eventDrivenAllocation");
+            rawSignalEmission = par("rawSignalEmission");
+            statisticsWindow = par("statisticsWindow");
             
             // Validate parameters
             validateParameters();
@@ -57,21 +96,66 @@ void NRModule::initialize(int stage)
             throw;
         }
         
+        // Allocation results are -1, 0 or 1, one bucket each; utilization is in [0, 1]
+        registerWindowedSignal(allocationStats, "resourceAllocation", -1, 2, 3);
+        registerWindowedSignal(qualityStats, "sidelinkQuality", 0, 1, 10);
+        
         // Initialize timers
         resourceAllocationTimer = new cMessage("resourceAllocationTimer");
-        modeSwitchEvaluationTimer = new cMessage("modeSwitchEvaluationTimer");
+        resourceAllocationTimer->setSchedulingPriority(1);  // Ticks see the requests made at the slot start
+        timeToTriggerTimer = new cMessage("timeToTriggerTimer");
         
         // Create managers
         resourceManager = new ResourceManager(this);
-        modeSwitchController = new ModeSwitchController(this);
+        resourceManager->setSlotDuration(getSlotDuration());
+        resourceManager->setPreemptionEnabled(par("preemptionEnabled").boolValue());
+        resourceManager->configureSensing(par("sensingWindow"),
+                                          par("sensingThreshold").doubleValue(),
+                                          par("sensingCandidateRatio").doubleValue());
+        if (par("useSharedOccupancyStore").boolValue()) {
+            connectOccupancyStore();
+        }
+        if (par("useSlotClock").boolValue()) {
+            connectSlotClock();
+        }
+        if (par("useNeighborIndex").boolValue()) {
+            connectNeighborIndex();
+        }
+        
+        // Sized once the sensing view is chosen, so only the view in use is allocated
+        resourceManager->setPeriodicity(par("periodicity"));
+        resourceManager->setPoolSize(par("numSubchannels").intValue(), par("numSymbols").intValue());
+        
+        // One trace ring is shared by all UEs; the first one asking for it opens it
+        traceFile = par("traceFile").stringValue();
+        if (!traceFile.empty()) {
+#ifdef NR_TRACE_ENABLED
+            if (!TraceRing::global().isOpen()) {
+                TraceRing::global().open(par("traceCapacity").intValue());
+            }
+#else
+            EV_WARN << "traceFile is set but tracing is not compiled in (CMake option NR_TRACE)" << endl;
+#endif
+        }
+        modeSwitchController = ModeSwitchController::create(par("modeSwitchPolicy").stringValue(), this);
+        modeSwitchController->configureEstimators(par("metricsEwmaAlpha").doubleValue(),
+                                                  par("rsrpFilterCoefficient").intValue(),
+                                                  par("metricsQuantileWindow").intValue());
+        updateSelectionMode();
         
         EV_INFO << "NRModule initialized with numerology " << numerologyIndex 
                 << " at " << carrierFrequency/1e9 << " GHz" << endl;
     }
     else if (stage == 1) {
-        // Schedule initial events
+        // Every slot from the next one on has a sample; without a tick an idle slot succeeds
+        int64_t windowSlots = rawSignalEmission ? 0 : std::llround(statisticsWindow / getSlotDuration());
+        slotStatistics.configure(windowSlots, this);
+        slotStatistics.start(slotAt(simTime()));
+        slotStatistics.setIdleValue(allocationStats.slot, 1);
+        slotStatistics.setIdleValue(qualityStats.slot, resourceManager->getUtilization());
+        
+        // Schedule initial events; mode switching waits for a time to trigger to be armed
         scheduleNextResourceAllocation();
-        scheduleNextModeSwitchEvaluation();
         
         // Initialize statistics collection
         initializeStatistics();
@@ -86,9 +170,8 @@ void NRModule::handleMessage(cMessage *msg)
                 processResourceAllocation();
                 scheduleNextResourceAllocation();
             }
-            else if (msg == modeSwitchEvaluationTimer) {
+            else if (msg == timeToTriggerTimer) {
                 evaluateModeSwitching();
-                scheduleNextModeSwitchEvaluation();
             }
         }
         else {
@@ -103,6 +186,28 @@ void NRModule::handleMessage(cMessage *msg)
     }
 }
 
+void NRModule::handleSlot(int64_t slot)
+{
+    Enter_Method_Silent();
+    
+    // Stale subscriptions, e.g. from a rescheduled tick, match neither slot
+    try {
+        if (allocationSlot >= 0 && slot >= allocationSlot) {
+            allocationSlot = -1;
+            processResourceAllocation();
+            scheduleNextResourceAllocation();
+        }
+        if (triggerSlot >= 0 && slot >= triggerSlot) {
+            triggerSlot = -1;
+            evaluateModeSwitching();
+        }
+    }
+    catch (const std::exception& e) {
+        EV_ERROR << "Error handling slot " << slot << ": " << e.what() << endl;
+        handleError(e.what());
+    }
+}
+
 void NRModule::validateParameters()
 {
     if (numerologyIndex < 0 || numerologyIndex > 4) {
@@ -116,43 +221,68 @@ void NRModule::validateParameters()
     if (bandwidth <= 0) {
         throw cRuntimeError("Invalid bandwidth %d", bandwidth);
     }
+    
+    if (!rawSignalEmission && statisticsWindow <= 0) {
+        throw cRuntimeError("Invalid statistics window %f", SIMTIME_DBL(statisticsWindow));
+    }
+    
+    // Windows are counted in slots
+    double windowSlots = statisticsWindow / getSlotDuration();
+    if (!rawSignalEmission && std::fabs(windowSlots - std::round(windowSlots)) > 1e-6) {
+        throw cRuntimeError("Statistics window %f s is not a whole number of slots", SIMTIME_DBL(statisticsWindow));
+    }
 }
 
 void NRModule::processResourceAllocation()
 {
     EV_INFO << "Processing resource allocation at " << simTime() << endl;
     
+    // Slots between ticks had nothing to do; count them instead of visiting them
+    int64_t slot = slotAt(simTime());
+    catchUpSlots(slot);
+    NR_TRACE(slot, getId(), TraceEvent::SLOT_TICK, 0, -1, 0);
+    
+    long result;
     try {
-        // Update resource utilization statistics
-        updateResourceUtilization();
-        
         // Perform resource allocation
         if (resourceManager->allocateResources()) {
-            emit(resourceAllocationSignal, 1);  // Success
+            processPendingRequests();
+            result = 1;  // Success
             logResourceStatus();
         }
         else {
-            emit(resourceAllocationSignal, 0);  // Failure
+            result = 0;  // Failure
             EV_WARN << "Resource allocation failed" << endl;
         }
     }
     catch (const std::exception& e) {
         EV_ERROR << "Error in resource allocation: " << e.what() << endl;
-        emit(resourceAllocationSignal, -1);  // Error
+        result = -1;  // Error
     }
+    
+    // Sampled after the tick's expiries and grants, as the idle slots that follow see the pool;
+    // a second tick in the same slot only updates what those idle slots repeat
+    bool newSlot = slot > slotStatistics.getLastSlot();
+    emitAllocationResult(slot, result, newSlot);
+    updateResourceUtilization(slot, newSlot);
 }
 
 void NRModule::evaluateModeSwitching()
 {
-    EV_INFO << "Evaluating mode switching at " << simTime() << endl;
+    EV_INFO << "Time to trigger expired at " << simTime() << endl;
+    
+    // The controller has seen every slot before this one
+    catchUpSlots(slotAt(simTime()));
     
     try {
-        if (isModeSwitchAllowed()) {
-            bool switchRequired = modeSwitchController->evaluateSwitch();
-            if (switchRequired) {
-                int newMode = modeSwitchController->determineTargetMode();
-                bool success = switchMode(newMode);
-                emit(modeSwitchSignal, success ? newMode : -1);
+        int newMode = modeSwitchController->onTriggerExpired();
+        if (newMode >= 0) {
+            bool success = switchMode(newMode);
+            emit(modeSwitchSignal, success ? newMode : -1);
+            
+            // A refused switch waits for the entering condition to change
+            if (!success) {
+                modeSwitchController->onSwitchRefused(newMode);
             }
         }
     }
@@ -162,31 +292,118 @@ void NRModule::evaluateModeSwitching()
     }
 }
 
+simtime_t NRModule::getSlotDuration() const
+{
+    // Slot duration based on numerology
+    return (double)(0.001) / (1 << numerologyIndex);  // in seconds
+}
+
+simtime_t NRModule::getNextResourceAllocationTime() const
+{
+    if (!eventDrivenAllocation) {
+        // Next resource allocation based on numerology
+        return simTime() + getSlotDuration();
+    }
+    
+    // First slot boundary not yet ticked if requests are queued, as in periodic mode a
+    // request made at a boundary is served there; otherwise the next expiry if any
+    simtime_t next = -1;
+    if (!pendingRequests.empty()) {
+        int64_t slot = std::max(static_cast<int64_t>(std::ceil(simTime() / getSlotDuration() - 1e-9)),
+                                slotStatistics.getLastSlot() + 1);
+        next = getSlotDuration() * static_cast<double>(slot);
+    }
+    simtime_t expiry = resourceManager->getNextExpiryTime();
+    if (expiry >= 0 && (next < 0 || expiry < next)) {
+        next = std::max(expiry, simTime());
+    }
+    return next;
+}
+
 void NRModule::scheduleNextResourceAllocation()
 {
-    // Schedule next resource allocation based on numerology
-    simtime_t slot_duration = (double)(0.001) / (1 << numerologyIndex);  // in seconds
-    scheduleAt(simTime() + slot_duration, resourceAllocationTimer);
+    simtime_t next = getNextResourceAllocationTime();
+    
+    if (slotClock) {
+        // Resubscribing for a different slot leaves the old subscription stale
+        int64_t slot = next < 0 ? -1 : slotClock->slotAt(next);
+        if (slot >= 0 && slot != allocationSlot) {
+            slotClock->subscribe(slotListenerId, slot);
+        }
+        allocationSlot = slot;
+        return;
+    }
+    
+    if (next < 0) {
+        cancelEvent(resourceAllocationTimer);
+        return;
+    }
+    if (resourceAllocationTimer->isScheduled()) {
+        if (resourceAllocationTimer->getArrivalTime() == next) {
+            return;
+        }
+        cancelEvent(resourceAllocationTimer);
+    }
+    scheduleAt(next, resourceAllocationTimer);
+}
+
+void NRModule::scheduleTimeToTrigger(simtime_t expiry)
+{
+    Enter_Method_Silent();
+    
+    // A negative expiry cancels; any pending expiry is replaced
+    if (slotClock) {
+        // First slot starting at or after the expiry; a cancelled subscription goes stale
+        int64_t slot = -1;
+        if (expiry >= 0) {
+            slot = slotClock->slotAt(expiry);
+            if (slotClock->slotStart(slot) < expiry) {
+                slot++;
+            }
+            if (slot != triggerSlot) {
+                slotClock->subscribe(slotListenerId, slot);
+            }
+        }
+        triggerSlot = slot;
+        return;
+    }
+    
+    cancelEvent(timeToTriggerTimer);
+    if (expiry >= 0) {
+        scheduleAt(expiry, timeToTriggerTimer);
+    }
 }
 
-void NRModule::scheduleNextModeSwitchEvaluation()
+void NRModule::triggerModeSwitchEvaluation()
 {
-    // Evaluate mode switching every 100ms
-    scheduleAt(simTime() + 0.1, modeSwitchEvaluationTimer);
+    Enter_Method_Silent();
+    
+    // Re-check the entering condition now, e.g. after the switching parameters changed
+    modeSwitchController->updateTrigger();
 }
 
 bool NRModule::requestResource(int priority, int size)
 {
-    if (!isResourceAvailable(size)) {
-        EV_WARN << "Resource not available for size " << size << endl;
-        return false;
-    }
+    Enter_Method_Silent();
     
+    // No free-count pre-check: a full pool can still serve the request by preemption
     try {
-        bool allocated = resourceManager->allocateSpecific(priority, size);
+        refreshSharedSensingView();
+        int preemptionsBefore = resourceManager->getTotalPreemptions();
+        AllocationResult result;
+        bool allocated = resourceManager->allocateSpecific(priority, size, &result);
+        emitPreemptions(preemptionsBefore);
+        onPoolChanged();
+        if (!allocated) {
+            modeSwitchController->recordDelivery(false);  // Dropped before transmission
+        }
         if (allocated) {
+            recordTransmission(result.blocks);
             lastAllocationTime = simTime();
             isTransmitting = true;
+            if (eventDrivenAllocation) {
+                scheduleNextResourceAllocation();  // The new allocation may expire first
+            }
             EV_INFO << "Resource allocated: priority=" << priority << ", size=" << size << endl;
         }
         return allocated;
@@ -197,10 +414,102 @@ bool NRModule::requestResource(int priority, int size)
     }
 }
 
+void NRModule::reportSensingMeasurement(int subchannel, double powerDbm)
+{
+    resourceManager->recordSensingMeasurement(subchannel, powerDbm);
+}
+
+void NRModule::reportRsrp(double rsrpDbm)
+{
+    modeSwitchController->recordRsrp(rsrpDbm);
+}
+
+void NRModule::processPacket(cPacket *packet)
+{
+    // Corrupted packets count as lost; latency is taken from delivered ones only
+    bool delivered = !packet->hasBitError();
+    modeSwitchController->recordDelivery(delivered);
+    if (delivered) {
+        modeSwitchController->recordLatency(simTime() - packet->getCreationTime());
+    }
+    
+    // The PHY attaches the measured RSRP when it has one
+    if (packet->hasPar("rsrp")) {
+        reportRsrp(packet->par("rsrp").doubleValue());
+    }
+    delete packet;
+}
+
+void NRModule::findNeighbors(double range, std::vector<int>& neighbors)
+{
+    Enter_Method_Silent();
+    
+    if (!neighborIndex) {
+        throw cRuntimeError("Neighbor queries need useNeighborIndex");
+    }
+    neighborIndex->queryRadius(mobility->getCurrentPosition(), range, neighbors);
+    neighbors.erase(std::remove(neighbors.begin(), neighbors.end(), getId()), neighbors.end());
+}
+
+void NRModule::findNearestNeighbors(int count, std::vector<int>& neighbors)
+{
+    Enter_Method_Silent();
+    
+    if (!neighborIndex) {
+        throw cRuntimeError("Neighbor queries need useNeighborIndex");
+    }
+    
+    // We are our own nearest neighbour, so ask for one more
+    neighborIndex->queryNearest(mobility->getCurrentPosition(), count + 1, neighbors);
+    neighbors.erase(std::remove(neighbors.begin(), neighbors.end(), getId()), neighbors.end());
+    if (static_cast<int>(neighbors.size()) > count) {
+        neighbors.resize(count);
+    }
+}
+
+void NRModule::queueResourceRequest(int priority, int size)
+{
+    Enter_Method_Silent();
+    
+    // Served together with the rest of the slot's requests at the next slot boundary
+    pendingRequests.push_back(AllocationRequest(priority, size));
+    if (eventDrivenAllocation) {
+        scheduleNextResourceAllocation();
+    }
+}
+
+void NRModule::processPendingRequests()
+{
+    if (pendingRequests.empty()) {
+        return;
+    }
+    
+    refreshSharedSensingView();
+    int preemptionsBefore = resourceManager->getTotalPreemptions();
+    int granted = resourceManager->allocateBatch(pendingRequests, batchResults);
+    emitPreemptions(preemptionsBefore);
+    for (const AllocationResult& result : batchResults) {
+        if (result.granted()) {
+            recordTransmission(result.blocks);
+        }
+        else {
+            modeSwitchController->recordDelivery(false);  // Dropped before transmission
+        }
+    }
+    if (granted > 0) {
+        lastAllocationTime = simTime();
+        isTransmitting = true;
+    }
+    EV_INFO << "Served " << pendingRequests.size() << " queued requests, "
+            << granted << " granted" << endl;
+    pendingRequests.clear();
+}
+
 void NRModule::releaseResource(int resourceId)
 {
     try {
         resourceManager->release(resourceId);
+        onPoolChanged();
         isTransmitting = false;
         EV_INFO << "Resource " << resourceId << " released" << endl;
     }
@@ -218,6 +527,10 @@ bool NRModule::switchMode(int newMode)
     
     try {
         bool success = modeSwitchController->executeSwitch(newMode);
+        if (success) {
+            updateSelectionMode();
+            NR_TRACE(slotAt(simTime()), getId(), TraceEvent::MODE_SWITCH, newMode, -1, 0);
+        }
         notifyModeSwitchComplete(success);
         return success;
     }
@@ -231,7 +544,58 @@ void NRModule::finish()
 {
     // Record final statistics
     recordScalar("resourceUtilization", resourceManager->getUtilization());
+    recordScalar("meanResourceUtilization", resourceManager->getMeanUtilization());
+    recordScalar("totalAllocations", resourceManager->getTotalAllocations());
+    recordScalar("failedAllocations", resourceManager->getFailedAllocations());
+    recordScalar("skippedAllocationSlots", skippedAllocationSlots);
     recordScalar("totalModeSwitches", modeSwitchController->getTotalSwitches());
+    recordScalar("cancelledTimeToTrigger", modeSwitchController->getTriggersCancelled());
+    recordScalar("resourcePoolMemory", resourceManager->getPoolMemoryFootprint(), "B");
+    recordScalar("totalPreemptions", resourceManager->getTotalPreemptions());
+    recordScalar("sensingMemory", resourceManager->getSensingMemoryFootprint(), "B");
+    recordScalar("moduleMemory", getMemoryFootprint(), "B");
+    
+    // Final estimates of the metrics the mode switching decisions were based on
+    recordScalar("estimatedDeliveryRatio", modeSwitchController->getPacketDeliveryRatio());
+    recordScalar("estimatedLatency", modeSwitchController->getLatency() / 1000.0, "s");
+    recordScalar("latencyP95", modeSwitchController->getLatencyQuantile(0.95) / 1000.0, "s");
+    recordScalar("estimatedUtilization", modeSwitchController->getResourceUtilization());
+    recordScalar("utilizationP95", modeSwitchController->getUtilizationQuantile(0.95));
+    if (modeSwitchController->hasRsrpMeasurement()) {
+        recordScalar("filteredRsrp", modeSwitchController->getFilteredRsrp(), "dBm");
+        recordScalar("rsrpP05", modeSwitchController->getRsrpQuantile(0.05), "dBm");
+    }
+    
+    // Residency per mode and switch counts per (from, to) pair; modes are numbered 1-4
+    const ModeHistory& history = modeSwitchController->getModeHistory();
+    for (int from = 0; from < ModeHistory::NUM_MODES; from++) {
+        std::string mode = std::to_string(from + 1);
+        recordScalar(("timeInMode" + mode).c_str(), history.getTimeInMode(from, simTime()), "s");
+        for (int to = 0; to < ModeHistory::NUM_MODES; to++) {
+            recordScalar(("modeTransitions" + mode + "to" + std::to_string(to + 1)).c_str(),
+                         history.getTransitionCount(from, to));
+        }
+    }
+    
+    // Slots after the last tick, then the last, partial window and the whole run
+    catchUpSlots(slotAt(simTime()) + 1);
+    if (!rawSignalEmission) {
+        slotStatistics.flush();
+        recordWindowedSignal(allocationStats, "resourceAllocation");
+        recordWindowedSignal(qualityStats, "sidelinkQuality");
+    }
+    
+#ifdef NR_TRACE_ENABLED
+    // No events follow, so the first module to finish writes the whole ring
+    TraceRing& ring = TraceRing::global();
+    if (!traceFile.empty() && ring.isOpen()) {
+        std::string file = partitionFileName(traceFile);
+        if (!ring.dump(file)) {
+            EV_ERROR << "Could not write trace file " << file << endl;
+        }
+        ring.close();
+    }
+#endif
     
     // Log final status
     EV_INFO << "NRModule finishing at " << simTime() 
@@ -249,23 +613,284 @@ void NRModule::initializeStatistics()
     // Initialize statistics recording
     WATCH(isTransmitting);
     WATCH(lastAllocationTime);
+    WATCH(skippedAllocationSlots);
 }
 
-void NRModule::updateResourceUtilization()
+void NRModule::updateResourceUtilization(int64_t slot, bool newSlot)
 {
     double utilization = resourceManager->getUtilization();
-    emit(sidelinkQualitySignal, utilization);
+    slotStatistics.setIdleValue(qualityStats.slot, utilization);
+    if (newSlot) {
+        slotStatistics.record(slot, qualityStats.slot, utilization);
+        modeSwitchController->recordUtilization(utilization);
+        if (rawSignalEmission) {
+            emit(sidelinkQualitySignal, utilization);
+        }
+    }
+}
+
+void NRModule::emitAllocationResult(int64_t slot, long result, bool newSlot)
+{
+    slotStatistics.setIdleValue(allocationStats.slot, result);
+    if (newSlot) {
+        slotStatistics.record(slot, allocationStats.slot, result);
+        if (rawSignalEmission) {
+            emit(resourceAllocationSignal, result);
+        }
+    }
+}
+
+void NRModule::catchUpSlots(int64_t endSlot)
+{
+    // Slots before endSlot without a tick repeat the idle values
+    long skipped = slotStatistics.catchUp(endSlot);
+    if (skipped == 0) {
+        return;
+    }
+    skippedAllocationSlots += skipped;
+    double utilization = slotStatistics.getIdleValue(qualityStats.slot);
+    modeSwitchController->recordUtilization(utilization, skipped);
+    if (rawSignalEmission) {
+        long result = static_cast<long>(slotStatistics.getIdleValue(allocationStats.slot));
+        for (long i = 0; i < skipped; i++) {
+            emit(resourceAllocationSignal, result);
+            emit(sidelinkQualitySignal, utilization);
+        }
+    }
+}
+
+void NRModule::onPoolChanged()
+{
+    // Slots that started before now saw the old pool; a tick at this instant sees the new one
+    catchUpSlots(static_cast<int64_t>(std::ceil(simTime() / getSlotDuration() - 1e-9)));
+    slotStatistics.setIdleValue(qualityStats.slot, resourceManager->getUtilization());
+}
+
+int64_t NRModule::slotAt(simtime_t time) const
+{
+    return static_cast<int64_t>(std::floor(time / getSlotDuration() + 1e-9));
+}
+
+void NRModule::registerWindowedSignal(WindowedSignal& stats, const char* name,
+                                      double histogramMin, double histogramMax, int numBuckets)
+{
+    // The idle values are kept in raw mode too; only the window summaries are not emitted
+    stats.binSignals.clear();
+    if (!rawSignalEmission) {
+        std::string base(name);
+        stats.countSignal = registerSignal((base + "Count").c_str());
+        stats.meanSignal = registerSignal((base + "Mean").c_str());
+        stats.minSignal = registerSignal((base + "Min").c_str());
+        stats.maxSignal = registerSignal((base + "Max").c_str());
+        
+        // One vector per bucket, recorded through the windowBin statistic template
+        cProperty* binTemplate = getProperties()->get("statisticTemplate", "windowBin");
+        for (int i = 0; i < numBuckets; i++) {
+            std::string binName = base + "Bin" + std::to_string(i);
+            stats.binSignals.push_back(registerSignal(binName.c_str()));
+            getEnvir()->addResultRecorders(this, stats.binSignals.back(), binName.c_str(), binTemplate);
+        }
+    }
+    stats.slot = slotStatistics.addSignal(histogramMin, histogramMax, numBuckets, 0);
+}
+
+void NRModule::windowClosed(const SlotStatistics&)
+{
+    flushWindowedSignal(allocationStats);
+    flushWindowedSignal(qualityStats);
+}
+
+void NRModule::flushWindowedSignal(const WindowedSignal& stats)
+{
+    const SignalAggregator& window = slotStatistics.getWindow(stats.slot);
+    if (window.empty()) {
+        return;
+    }
+    emit(stats.countSignal, window.getCount());
+    emit(stats.meanSignal, window.getMean());
+    emit(stats.minSignal, window.getMin());
+    emit(stats.maxSignal, window.getMax());
+    for (int i = 0; i < window.getNumBuckets(); i++) {
+        emit(stats.binSignals[i], window.getBucketCount(i));
+    }
+}
+
+void NRModule::recordWindowedSignal(const WindowedSignal& stats, const char* name)
+{
+    std::string base(name);
+    const SignalAggregator& total = slotStatistics.getTotal(stats.slot);
+    recordScalar((base + "Samples").c_str(), total.getCount());
+    recordScalar((base + "Mean").c_str(), total.getMean());
+    recordScalar((base + "Min").c_str(), total.getMin());
+    recordScalar((base + "Max").c_str(), total.getMax());
+    for (int i = 0; i < total.getNumBuckets(); i++) {
+        recordScalar((base + "Bin" + std::to_string(i)).c_str(), total.getBucketCount(i));
+    }
+    recordScalar((base + "Underflow").c_str(), total.getUnderflow());
+    recordScalar((base + "Overflow").c_str(), total.getOverflow());
+}
+
+void NRModule::emitPreemptions(int previousTotal)
+{
+    int preempted = resourceManager->getTotalPreemptions() - previousTotal;
+    if (preempted > 0) {
+        emit(preemptionSignal, preempted);
+    }
+}
+
+void NRModule::connectOccupancyStore()
+{
+    cModule* storeModule = findPartitionModule(par("occupancyStoreModule").stringValue());
+    if (!storeModule) {
+        throw cRuntimeError("Shared occupancy store '%s' not found in this partition",
+                            par("occupancyStoreModule").stringValue());
+    }
+    occupancyStore = check_and_cast<ChannelOccupancyStore*>(storeModule);
+    
+    // Views are filtered by our own position
+    mobility = findMobility();
+    if (!mobility) {
+        throw cRuntimeError("Shared occupancy store requires a mobility submodule in the containing node");
+    }
+    
+    receptionRange = par("receptionRange").doubleValue();
+    txPower = par("txPower").doubleValue();
+    resourceManager->setSharedSensingView(true);
+}
+
+inet::IMobility* NRModule::findMobility()
+{
+    cModule* host = inet::findContainingNode(this);
+    cModule* mobilityModule = host ? host->getSubmodule("mobility") : nullptr;
+    inet::IMobility* found = dynamic_cast<inet::IMobility*>(mobilityModule);
+    if (found) {
+        mobilityModuleId = mobilityModule->getId();
+    }
+    return found;
+}
+
+void NRModule::connectNeighborIndex()
+{
+    cModule* indexModule = findPartitionModule(par("neighborIndexModule").stringValue());
+    if (!indexModule) {
+        throw cRuntimeError("Neighbor index '%s' not found in this partition",
+                            par("neighborIndexModule").stringValue());
+    }
+    neighborIndex = check_and_cast<NeighborIndex*>(indexModule);
+    
+    mobility = findMobility();
+    if (!mobility) {
+        throw cRuntimeError("Neighbor index requires a mobility submodule in the containing node");
+    }
+    
+    // Keyed by our id, which is also the transmitter id in the occupancy store
+    neighborIndexModuleId = neighborIndex->getId();
+    neighborIndex->track(getId(), check_and_cast<cModule*>(mobility));
+}
+
+void NRModule::connectSlotClock()
+{
+    cModule* clockModule = findPartitionModule(par("slotClockModule").stringValue());
+    if (!clockModule) {
+        throw cRuntimeError("Slot clock '%s' not found in this partition", par("slotClockModule").stringValue());
+    }
+    slotClock = check_and_cast<SlotClock*>(clockModule);
+    
+    // Slot indices are shared with the clock, so the slot lengths must agree
+    if (slotClock->getSlotDuration() != getSlotDuration()) {
+        throw cRuntimeError("Slot clock slot duration %f s does not match numerology %d",
+                            SIMTIME_DBL(slotClock->getSlotDuration()), numerologyIndex);
+    }
+    
+    // Module ids give a call order that is stable across runs
+    slotClockModuleId = slotClock->getId();
+    slotListenerId = slotClock->registerListener(this, getId());
+}
+
+std::string NRModule::partitionFileName(const std::string& file) const
+{
+    // Every partition has its own ring, so each writes its own file: results/nr.trc becomes results/nr-2.trc
+    if (getSimulation()->getParsimNumPartitions() <= 0) {
+        return file;
+    }
+    std::string suffix = "-" + std::to_string(getSimulation()->getParsimProcId());
+    size_t dot = file.find_last_of('.');
+    size_t slash = file.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return file + suffix;
+    }
+    return file.substr(0, dot) + suffix + file.substr(dot);
+}
+
+cModule* NRModule::findPartitionModule(const char* name) const
+{
+    // A module vector has one element per partition; other partitions only hold placeholders
+    cModule* network = getSimulation()->getSystemModule();
+    cModule* module = network->getSubmodule(name);
+    if (!module) {
+        module = network->getSubmodule(name, getSimulation()->getParsimProcId());
+    }
+    return module && !module->isPlaceholder() ? module : nullptr;
+}
+
+void NRModule::refreshSharedSensingView()
+{
+    if (!occupancyStore || !resourceManager->isSensingBasedSelection()) {
+        return;
+    }
+    int subchannels = resourceManager->getNumSubchannels();
+    if (subchannels <= 0 || sharedViewTime == simTime()) {
+        return;  // No pool yet, or already up to date for this slot
+    }
+    
+    sharedViewSums.resize(subchannels);
+    int64_t observed = occupancyStore->fillView(getId(), mobility->getCurrentPosition(),
+                                                receptionRange, sharedViewSums);
+    resourceManager->applySensingView(sharedViewSums, observed);
+    sharedViewTime = simTime();
 }
 
-bool NRModule::isResourceAvailable(int size) const
+void NRModule::recordTransmission(const BlockRange& blocks)
 {
-    return resourceManager->checkAvailability(size);
+    if (!occupancyStore || blocks.empty()) {
+        return;
+    }
+    
+    // Blocks are laid out subchannel-major, so a run covers consecutive subchannels
+    int symbols = resourceManager->getNumSymbols();
+    int firstSubchannel = blocks.first / symbols;
+    int lastSubchannel = (blocks.first + blocks.count - 1) / symbols;
+    occupancyStore->recordTransmission(getId(), mobility->getCurrentPosition(),
+                                       firstSubchannel, lastSubchannel - firstSubchannel + 1, txPower);
+}
+
+size_t NRModule::getMemoryFootprint() const
+{
+    // This module, its managers and their heap storage; shared network modules are not included
+    size_t bytes = sizeof(*this);
+    bytes += pendingRequests.capacity() * sizeof(AllocationRequest);
+    bytes += batchResults.capacity() * sizeof(AllocationResult);
+    bytes += sharedViewSums.capacity() * sizeof(float);
+    if (resourceManager) {
+        bytes += resourceManager->getMemoryFootprint();
+    }
+    if (modeSwitchController) {
+        bytes += modeSwitchController->getMemoryFootprint();
+    }
+    return bytes;
 }
 
 bool NRModule::isModeSwitchAllowed() const
 {
     // Prevent too frequent mode switches
-    return (simTime() - modeSwitchController->getLastSwitchTime()) > 1.0;
+    return (simTime() - modeSwitchController->getLastSwitchTime()) >= 1.0;
+}
+
+void NRModule::updateSelectionMode()
+{
+    // Autonomous modes pick resources from the sensing window
+    V2XMode mode = modeSwitchController->getCurrentMode();
+    resourceManager->setSensingBasedSelection(mode == V2XMode::MODE_2 || mode == V2XMode::MODE_4);
 }
 
 void NRModule::notifyModeSwitchComplete(bool success)
@@ -3,6 +3,7 @@
 
 #include <omnetpp.h>
 #include <inet/common/INETDefs.h>
+#include <inet/mobility/contract/IMobility.h>
 
 // Forward declarations
 namespace simu5g {
@@ -11,6 +12,10 @@ namespace simu5g {
 
 #include "ResourceManager.h"
 #include "ModeSwitchController.h"
+#include "ChannelOccupancyStore.h"
+#include "NeighborIndex.h"
+#include "SlotClock.h"
+#include "SlotStatistics.h"
 
 using namespace omnetpp;
 
@@ -22,7 +27,7 @@ namespace nr {
  * This module handles the core functionality of 5G NR V2X sidelink,
  * including resource allocation and mode switching.
  */
-class NRModule : public cSimpleModule
+class NRModule : public cSimpleModule, public ISlotListener, public SlotStatistics::Listener
 {
   protected:
     // Configuration parameters
@@ -30,6 +35,7 @@ class NRModule : public cSimpleModule
     double carrierFrequency;     ///< Carrier frequency in Hz
     int bandwidth;               ///< Bandwidth in MHz
     bool sidelinkEnabled;        ///< Flag for sidelink capability
+    bool eventDrivenAllocation;  ///< Tick only for pending requests and expiries
     
     // Resource management
     ResourceManager* resourceManager;
@@ -39,14 +45,58 @@ class NRModule : public cSimpleModule
     simsignal_t resourceAllocationSignal;
     simsignal_t modeSwitchSignal;
     simsignal_t sidelinkQualitySignal;
+    simsignal_t preemptionSignal;
+    
+    // Per-window summaries of the per-slot signals
+    struct WindowedSignal {
+        simsignal_t countSignal;
+        simsignal_t meanSignal;
+        simsignal_t minSignal;
+        simsignal_t maxSignal;
+        std::vector<simsignal_t> binSignals;  ///< Per-window count of each histogram bucket
+        int slot;                     ///< Signal index in slotStatistics
+    };
+    WindowedSignal allocationStats;
+    WindowedSignal qualityStats;
+    bool rawSignalEmission;           ///< Emit every sample instead of window summaries
+    simtime_t statisticsWindow;
+    SlotStatistics slotStatistics;    ///< One sample per slot, skipped slots included
     
     // Internal state
     bool isTransmitting;
     simtime_t lastAllocationTime;
+    long skippedAllocationSlots; ///< Slots without a tick in event-driven mode
+    
+    // Requests collected during the current slot, served in one batch
+    std::vector<AllocationRequest> pendingRequests;
+    std::vector<AllocationResult> batchResults;
+    
+    // Shared channel occupancy store, null when each UE senses on its own
+    ChannelOccupancyStore* occupancyStore;
+    inet::IMobility* mobility;
+    double receptionRange;       ///< Range within which other transmissions are sensed, in m
+    double txPower;              ///< Transmit power per subchannel in dBm
+    std::vector<float> sharedViewSums;
+    simtime_t sharedViewTime;    ///< Time the shared view was last applied
     
-    // Self messages for periodic events
+    // Network-wide spatial index of the UEs, null when not used
+    NeighborIndex* neighborIndex;
+    int neighborIndexModuleId;
+    int mobilityModuleId;
+    
+    // Self messages: periodic allocation ticks and the pending time-to-trigger expiry
     cMessage *resourceAllocationTimer;
-    cMessage *modeSwitchEvaluationTimer;
+    cMessage *timeToTriggerTimer;
+    
+    // Network-wide slot clock replacing the timers above, null when not used
+    SlotClock* slotClock;
+    int slotClockModuleId;
+    int slotListenerId;
+    int64_t allocationSlot;      ///< Slot of the next allocation tick, -1 if none
+    int64_t triggerSlot;         ///< Slot the time to trigger expires in, -1 if none
+    
+    // Binary trace output, empty when not tracing
+    std::string traceFile;
     
   protected:
     // OMNeT++ module interface
@@ -56,9 +106,12 @@ class NRModule : public cSimpleModule
     virtual int numInitStages() const override { return 2; }
     
     // Internal utility functions
+    simtime_t getSlotDuration() const;
+    simtime_t getNextResourceAllocationTime() const;
     void scheduleNextResourceAllocation();
-    void scheduleNextModeSwitchEvaluation();
     void processResourceAllocation();
+    void processPendingRequests();
+    void processPacket(cPacket *packet);
     void evaluateModeSwitching();
     
   public:
@@ -69,13 +122,25 @@ class NRModule : public cSimpleModule
     bool isSidelinkEnabled() const { return sidelinkEnabled; }
     double getCarrierFrequency() const { return carrierFrequency; }
     int getBandwidth() const { return bandwidth; }
+    size_t getMemoryFootprint() const;
+    
+    // Slot clock interface
+    virtual void handleSlot(int64_t slot) override;
     
     // Resource management interface
     bool requestResource(int priority, int size);
+    void queueResourceRequest(int priority, int size);
     void releaseResource(int resourceId);
+    void reportSensingMeasurement(int subchannel, double powerDbm);
+    void reportRsrp(double rsrpDbm);
+    
+    // Neighbour queries, module ids of other NRModules; need the neighbor index
+    void findNeighbors(double range, std::vector<int>& neighbors);
+    void findNearestNeighbors(int count, std::vector<int>& neighbors);
     
     // Mode switching interface
     void triggerModeSwitchEvaluation();
+    void scheduleTimeToTrigger(simtime_t expiry);
     bool switchMode(int newMode);
     
   private:
@@ -90,11 +155,33 @@ class NRModule : public cSimpleModule
     void validateParameters();
     
     // Resource management helpers
-    bool isResourceAvailable(int size) const;
-    void updateResourceUtilization();
+    void updateResourceUtilization(int64_t slot, bool newSlot);
+    void emitPreemptions(int previousTotal);
+    void emitAllocationResult(int64_t slot, long result, bool newSlot);
+    void catchUpSlots(int64_t endSlot);
+    void onPoolChanged();
+    int64_t slotAt(simtime_t time) const;
+    
+    // Windowed statistics helpers
+    void registerWindowedSignal(WindowedSignal& stats, const char* name,
+                                double histogramMin, double histogramMax, int numBuckets);
+    virtual void windowClosed(const SlotStatistics& statistics) override;
+    void flushWindowedSignal(const WindowedSignal& stats);
+    void recordWindowedSignal(const WindowedSignal& stats, const char* name);
+    
+    // Shared occupancy store helpers
+    cModule* findPartitionModule(const char* name) const;
+    std::string partitionFileName(const std::string& file) const;
+    inet::IMobility* findMobility();
+    void connectOccupancyStore();
+    void connectNeighborIndex();
+    void connectSlotClock();
+    void refreshSharedSensingView();
+    void recordTransmission(const BlockRange& blocks);
     
     // Mode switching helpers
     bool isModeSwitchAllowed() const;
+    void updateSelectionMode();
     void notifyModeSwitchComplete(bool success);
 };
 
@@ -0,0 +1,100 @@
+#include "NeighborIndex.h"
+#include <inet/mobility/contract/IMobility.h>
+
+namespace nr {
+
+Define_Module(NeighborIndex);
+
+NeighborIndex::NeighborIndex() :
+    totalUpdates(0),
+    cellChanges(0),
+    totalQueries(0)
+{
+}
+
+void NeighborIndex::initialize()
+{
+    // Cells cover the playground of the network we are in
+    cModule* network = getParentModule();
+    double sizeX = network->par("playgroundSizeX").doubleValue();
+    double sizeY = network->par("playgroundSizeY").doubleValue();
+    double cellSize = par("cellSize").doubleValue();
+    if (cellSize <= 0) {
+        throw cRuntimeError("Invalid cell size %f", cellSize);
+    }
+    grid.configure(sizeX, sizeY, cellSize);
+    
+    WATCH(totalUpdates);
+    WATCH(cellChanges);
+    
+    EV_INFO << "NeighborIndex initialized with " << cellSize << " m cells over "
+            << sizeX << " x " << sizeY << " m" << endl;
+}
+
+void NeighborIndex::handleMessage(cMessage *)
+{
+    throw cRuntimeError("NeighborIndex does not process messages");
+}
+
+void NeighborIndex::finish()
+{
+    recordScalar("neighborIndexUpdates", totalUpdates);
+    recordScalar("neighborIndexCellChanges", cellChanges);
+    recordScalar("neighborIndexQueries", totalQueries);
+    recordScalar("neighborIndexMemory", grid.getMemoryFootprint(), "B");
+}
+
+void NeighborIndex::track(int key, cModule* mobilityModule)
+{
+    Enter_Method_Silent();
+    
+    // The position arrives with the first state change, emitted when the mobility initializes it
+    check_and_cast<inet::IMobility*>(mobilityModule);
+    int source = mobilityModule->getId();
+    if (source >= static_cast<int>(keyBySource.size())) {
+        keyBySource.resize(source + 1, -1);
+    }
+    keyBySource[source] = key;
+    mobilityModule->subscribe(inet::IMobility::mobilityStateChangedSignal, this);
+}
+
+void NeighborIndex::untrack(int key, int mobilityModuleId)
+{
+    Enter_Method_Silent();
+    
+    // The mobility module may already be gone; its subscriptions went with it
+    if (mobilityModuleId >= 0 && mobilityModuleId < static_cast<int>(keyBySource.size())) {
+        keyBySource[mobilityModuleId] = -1;
+    }
+    grid.remove(key);
+}
+
+void NeighborIndex::queryRadius(const inet::Coord& position, double radius, std::vector<int>& keys)
+{
+    grid.queryRadius(position.x, position.y, radius, keys);
+    totalQueries++;
+}
+
+void NeighborIndex::queryNearest(const inet::Coord& position, int count, std::vector<int>& keys)
+{
+    grid.queryNearest(position.x, position.y, count < 0 ? 0 : count, keys);
+    totalQueries++;
+}
+
+void NeighborIndex::receiveSignal(cComponent *source, simsignal_t, cObject *obj, cObject *)
+{
+    int id = source->getId();
+    int key = id < static_cast<int>(keyBySource.size()) ? keyBySource[id] : -1;
+    inet::IMobility* mobility = dynamic_cast<inet::IMobility*>(obj);
+    if (key < 0 || !mobility) {
+        return;
+    }
+    
+    inet::Coord position = mobility->getCurrentPosition();
+    if (grid.update(key, position.x, position.y)) {
+        cellChanges++;
+    }
+    totalUpdates++;
+}
+
+}  // namespace nr
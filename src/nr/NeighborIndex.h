@@ -0,0 +1,63 @@
+#ifndef __NEIGHBOR_INDEX_H
+#define __NEIGHBOR_INDEX_H
+
+#include <omnetpp.h>
+#include <inet/common/INETDefs.h>
+#include <inet/common/geometry/common/Coord.h>
+#include <vector>
+
+#include "SpatialGrid.h"
+
+using namespace omnetpp;
+
+namespace nr {
+
+/**
+ * @brief Network-wide spatial index of vehicle positions
+ *
+ * NRModules register with the mobility module of their node; the index
+ * then follows that module's mobility state changes and keeps the
+ * position in a uniform grid over the playground, so a position update
+ * touches one or two cells and never the other vehicles. Radius and
+ * k-nearest queries return the registered keys (NRModule ids) in
+ * O(neighbours), which bounds the candidate receivers and interferers a
+ * UE has to consider.
+ */
+class NeighborIndex : public cSimpleModule, public cListener
+{
+  protected:
+    SpatialGrid grid;
+    std::vector<int> keyBySource;   ///< Registered key per mobility module id, -1 if none
+    
+    // Statistics
+    long totalUpdates;
+    long cellChanges;
+    long totalQueries;
+    
+  protected:
+    // OMNeT++ module interface
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+    
+  public:
+    NeighborIndex();
+    
+    // Registration of tracked nodes by their mobility module, before it initializes its position
+    void track(int key, cModule* mobilityModule);
+    void untrack(int key, int mobilityModuleId);
+    
+    // Queries, the output is overwritten
+    void queryRadius(const inet::Coord& position, double radius, std::vector<int>& keys);
+    void queryNearest(const inet::Coord& position, int count, std::vector<int>& keys);
+    
+    // Mobility state changes of the tracked nodes
+    virtual void receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj, cObject *details) override;
+    
+    // Status queries
+    size_t getTrackedCount() const { return grid.size(); }
+};
+
+}  // namespace nr
+
+#endif // __NEIGHBOR_INDEX_H
@@ -0,0 +1,198 @@
+#include "OccupancyBitmap.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace nr {
+
+OccupancyBitmap::OccupancyBitmap() :
+    numBits(0)
+{
+}
+
+OccupancyBitmap::OccupancyBitmap(int numBits) :
+    numBits(0)
+{
+    resize(numBits);
+}
+
+void OccupancyBitmap::resize(int bits)
+{
+    if (bits < 0) {
+        throw std::invalid_argument("OccupancyBitmap: negative size");
+    }
+    numBits = bits;
+    words.assign((bits + BITS_PER_WORD - 1) / BITS_PER_WORD, 0);
+}
+
+void OccupancyBitmap::clear()
+{
+    std::fill(words.begin(), words.end(), 0);
+}
+
+void OccupancyBitmap::set(int index)
+{
+    words[index / BITS_PER_WORD] |= Word(1) << (index % BITS_PER_WORD);
+}
+
+void OccupancyBitmap::reset(int index)
+{
+    words[index / BITS_PER_WORD] &= ~(Word(1) << (index % BITS_PER_WORD));
+}
+
+bool OccupancyBitmap::test(int index) const
+{
+    return (words[index / BITS_PER_WORD] >> (index % BITS_PER_WORD)) & 1;
+}
+
+void OccupancyBitmap::setRange(int first, int count)
+{
+    assignRange(first, count, true);
+}
+
+void OccupancyBitmap::resetRange(int first, int count)
+{
+    assignRange(first, count, false);
+}
+
+bool OccupancyBitmap::anyInRange(int first, int count) const
+{
+    if (count <= 0) {
+        return false;
+    }
+    if (first < 0 || first + count > numBits) {
+        throw std::out_of_range("OccupancyBitmap: range outside bitmap");
+    }
+
+    int last = first + count - 1;
+    int firstWord = first / BITS_PER_WORD;
+    int lastWord = last / BITS_PER_WORD;
+
+    for (int w = firstWord; w <= lastWord; w++) {
+        Word mask = ~Word(0);
+        if (w == firstWord) {
+            mask &= ~Word(0) << (first % BITS_PER_WORD);
+        }
+        if (w == lastWord) {
+            mask &= ~Word(0) >> (BITS_PER_WORD - 1 - last % BITS_PER_WORD);
+        }
+        if (words[w] & mask) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int OccupancyBitmap::count() const
+{
+    int total = 0;
+    for (Word word : words) {
+        total += popcount(word);
+    }
+    return total;
+}
+
+bool OccupancyBitmap::hasFree(int required) const
+{
+    if (required <= 0) {
+        return true;
+    }
+
+    // Stop as soon as enough clear bits have been seen
+    int freeCount = 0;
+    int remaining = numBits;
+    for (Word word : words) {
+        int bitsInWord = remaining < BITS_PER_WORD ? remaining : BITS_PER_WORD;
+        freeCount += bitsInWord - popcount(word);
+        if (freeCount >= required) {
+            return true;
+        }
+        remaining -= bitsInWord;
+    }
+    return false;
+}
+
+int OccupancyBitmap::findFirstSet(int from) const
+{
+    if (from < 0) {
+        from = 0;
+    }
+    if (from >= numBits) {
+        return -1;
+    }
+
+    int wordIndex = from / BITS_PER_WORD;
+    Word word = words[wordIndex] & (~Word(0) << (from % BITS_PER_WORD));
+    while (true) {
+        if (word != 0) {
+            return wordIndex * BITS_PER_WORD + countTrailingZeros(word);
+        }
+        if (++wordIndex >= wordCount()) {
+            return -1;
+        }
+        word = words[wordIndex];
+    }
+}
+
+int OccupancyBitmap::findFirstClear(int from) const
+{
+    if (from < 0) {
+        from = 0;
+    }
+    if (from >= numBits) {
+        return -1;
+    }
+
+    int wordIndex = from / BITS_PER_WORD;
+    Word word = ~words[wordIndex] & (~Word(0) << (from % BITS_PER_WORD));
+    while (true) {
+        if (word != 0) {
+            int index = wordIndex * BITS_PER_WORD + countTrailingZeros(word);
+            return index < numBits ? index : -1;  // Padding bits read as clear
+        }
+        if (++wordIndex >= wordCount()) {
+            return -1;
+        }
+        word = ~words[wordIndex];
+    }
+}
+
+void OccupancyBitmap::assignRange(int first, int count, bool value)
+{
+    if (count <= 0) {
+        return;
+    }
+    if (first < 0 || first + count > numBits) {
+        throw std::out_of_range("OccupancyBitmap: range outside bitmap");
+    }
+
+    int last = first + count - 1;
+    int firstWord = first / BITS_PER_WORD;
+    int lastWord = last / BITS_PER_WORD;
+
+    for (int w = firstWord; w <= lastWord; w++) {
+        Word mask = ~Word(0);
+        if (w == firstWord) {
+            mask &= ~Word(0) << (first % BITS_PER_WORD);
+        }
+        if (w == lastWord) {
+            mask &= ~Word(0) >> (BITS_PER_WORD - 1 - last % BITS_PER_WORD);
+        }
+        if (value) {
+            words[w] |= mask;
+        } else {
+            words[w] &= ~mask;
+        }
+    }
+}
+
+int OccupancyBitmap::popcount(Word word)
+{
+    return __builtin_popcountll(word);
+}
+
+int OccupancyBitmap::countTrailingZeros(Word word)
+{
+    return __builtin_ctzll(word);
+}
+
+}  // namespace nr
\ No newline at end of file
@@ -0,0 +1,64 @@
+#ifndef __OCCUPANCY_BITMAP_H
+#define __OCCUPANCY_BITMAP_H
+
+#include <cstdint>
+#include <vector>
+
+namespace nr {
+
+/**
+ * @brief Word-packed occupancy bitmap over the sidelink resource grid
+ *
+ * One bit per resource block, laid out subchannel-major
+ * (index = subchannelIndex * numSymbols + symbolIndex), matching the order
+ * in which ResourceManager builds its pool. A set bit means occupied.
+ * Counting uses popcount and searching uses find-first-set, so queries
+ * cost O(words) instead of O(blocks). Padding bits in the last word are
+ * always kept clear.
+ */
+class OccupancyBitmap
+{
+  public:
+    typedef uint64_t Word;
+    static const int BITS_PER_WORD = 64;
+
+    OccupancyBitmap();
+    explicit OccupancyBitmap(int numBits);
+
+    // Sizing
+    void resize(int numBits);
+    void clear();
+    int size() const { return numBits; }
+    int wordCount() const { return static_cast<int>(words.size()); }
+
+    // Single-bit access
+    void set(int index);
+    void reset(int index);
+    bool test(int index) const;
+
+    // Range access over [first, first + count)
+    void setRange(int first, int count);
+    void resetRange(int first, int count);
+    bool anyInRange(int first, int count) const;
+
+    // Counting
+    int count() const;
+    int countFree() const { return numBits - count(); }
+    bool hasFree(int required) const;
+
+    // Searching, returning -1 if nothing is found at or after 'from'
+    int findFirstSet(int from = 0) const;
+    int findFirstClear(int from = 0) const;
+
+  private:
+    int numBits;
+    std::vector<Word> words;
+
+    void assignRange(int first, int count, bool value);
+    static int popcount(Word word);
+    static int countTrailingZeros(Word word);
+};
+
+}  // namespace nr
+
+#endif // __OCCUPANCY_BITMAP_H
\ No newline at end of file
@@ -1,27 +1,38 @@
 #include "ResourceManager.h"
 #include "NRModule.h"
 #include <algorithm>
+#include <cmath>
 #include <stdexcept>
 
 namespace nr {
 
 // Define static constants
-const simtime_t ResourceManager::CLEANUP_INTERVAL = 0.1;  // 100ms
+const simtime_t ResourceManager::DEFAULT_SLOT_DURATION = 0.001;  // 1ms, numerology 0
 
 ResourceManager::ResourceManager(NRModule* parent) :
     parentModule(parent),
+    traceId(-1),
     numSubchannels(0),
     numSymbols(0),
     periodicity(0),
+    slotDuration(DEFAULT_SLOT_DURATION),
+    sensingWindow(0),
+    sensingBasedSelection(false),
+    sharedSensingView(false),
+    sensingCandidatesSlot(-1),
     currentUtilization(0.0),
+    utilizationIntegral(0.0),
+    utilizationSince(0),
     totalAllocations(0),
     failedAllocations(0),
+    totalPreemptions(0),
     initialized(false),
-    lastCleanupTime(0)
+    preemptionEnabled(false)
 {
     if (!parent) {
         throw std::runtime_error("ResourceManager: Parent module cannot be null");
     }
+    traceId = parent->getId();
 }
 
 ResourceManager::~ResourceManager()
@@ -37,10 +48,8 @@ bool ResourceManager::allocateResources()
         }
     }
 
-    // Clean expired allocations if needed
-    if (simTime() - lastCleanupTime >= CLEANUP_INTERVAL) {
-        cleanExpiredAllocations();
-    }
+    // Release allocations whose expiry slot has been reached
+    cleanExpiredAllocations();
 
     try {
         // Update utilization statistics
@@ -53,7 +62,7 @@ bool ResourceManager::allocateResources()
     }
 }
 
-bool ResourceManager::allocateSpecific(int priority, int size)
+bool ResourceManager::allocateSpecific(int priority, int size, AllocationResult* result)
 {
     if (!validateRequest(priority, size)) {
         EV_WARN << "Invalid resource request: priority=" << priority << ", size=" << size << endl;
@@ -61,10 +70,14 @@ bool ResourceManager::allocateSpecific(int priority, int size)
     }
 
     try {
-        // Find available resource blocks
-        auto blocks = findAvailableBlocks(size);
+        // Find available resource blocks, evicting lower priorities if allowed
+        BlockRange blocks = selectBlocks(size);
+        if (blocks.empty() && preemptionEnabled) {
+            blocks = preemptForRequest(priority, size);
+        }
         if (blocks.empty()) {
             EV_INFO << "No available blocks found for size " << size << endl;
+            NR_TRACE(slotIndex(simTime()), traceId, TraceEvent::ALLOCATION_FAILED, priority, -1, size);
             failedAllocations++;
             return false;
         }
@@ -77,8 +90,13 @@ bool ResourceManager::allocateSpecific(int priority, int size)
         }
 
         // Allocate the blocks
-        markBlocksOccupied(blocks, priority);
+        int resourceId = markBlocksOccupied(blocks, priority);
         totalAllocations++;
+        updateUtilizationStats();
+        if (result) {
+            result->resourceId = resourceId;
+            result->blocks = blocks;
+        }
 
         // Log allocation
         logAllocation(blocks, priority);
@@ -91,27 +109,85 @@ bool ResourceManager::allocateSpecific(int priority, int size)
     }
 }
 
+int ResourceManager::allocateBatch(const std::vector<AllocationRequest>& requests,
+                                   std::vector<AllocationResult>& results)
+{
+    // Results line up with requests; both vectors are reused across slots
+    results.assign(requests.size(), AllocationResult());
+    if (requests.empty()) {
+        return 0;
+    }
+    
+    if (!initialized && !initializePool()) {
+        failedAllocations += static_cast<int>(requests.size());
+        return 0;
+    }
+    
+    // Serve higher priorities first, ties in submission order
+    batchOrder.resize(requests.size());
+    for (size_t i = 0; i < batchOrder.size(); i++) {
+        batchOrder[i] = static_cast<int>(i);
+    }
+    std::sort(batchOrder.begin(), batchOrder.end(), [&requests](int a, int b) {
+        if (requests[a].priority != requests[b].priority) {
+            return requests[a].priority > requests[b].priority;
+        }
+        return a < b;
+    });
+    
+    int granted = 0;
+    try {
+        for (int index : batchOrder) {
+            const AllocationRequest& request = requests[index];
+            if (!validateRequest(request.priority, request.size)) {
+                failedAllocations++;
+                continue;
+            }
+            
+            // Blocks come straight from the extent indexes, so they cannot conflict
+            BlockRange blocks = selectBlocks(request.size);
+            if (blocks.empty() && preemptionEnabled) {
+                blocks = preemptForRequest(request.priority, request.size);
+            }
+            if (blocks.empty()) {
+                NR_TRACE(slotIndex(simTime()), traceId, TraceEvent::ALLOCATION_FAILED,
+                         request.priority, -1, request.size);
+                failedAllocations++;
+                continue;
+            }
+            
+            results[index].resourceId = markBlocksOccupied(blocks, request.priority);
+            results[index].blocks = blocks;
+            totalAllocations++;
+            granted++;
+        }
+    }
+    catch (const std::exception& e) {
+        handleAllocationError(e.what());
+    }
+    
+    updateUtilizationStats();
+    EV_INFO << "Batch allocation granted " << granted << " of " << requests.size() << " requests" << endl;
+    return granted;
+}
+
 void ResourceManager::release(int resourceId)
 {
+    // Also rejects stale handles of allocations that were already released
     if (!isValidResourceId(resourceId)) {
         EV_ERROR << "Invalid resource ID: " << resourceId << endl;
         return;
     }
 
     try {
-        auto it = activeAllocations.find(resourceId);
-        if (it != activeAllocations.end()) {
-            // Release all blocks associated with this allocation
-            for (auto block : it->second) {
-                block->occupied = false;
-                block->priority = 0;
-                block->allocTime = 0;
-            }
-            activeAllocations.erase(it);
-            
-            EV_INFO << "Released resource ID " << resourceId << endl;
-            updateUtilizationStats();
-        }
+        // Its expiry wheel entry goes stale and is skipped when drained
+        NR_TRACE(slotIndex(simTime()), traceId, TraceEvent::RELEASE, 0,
+                 activeAllocations.find(resourceId)->blocks.first,
+                 activeAllocations.find(resourceId)->blocks.count);
+        releaseAllocation(resourceId);
+        
+        EV_INFO << "Released resource ID " << resourceId << endl;
+        updateUtilizationStats();
     }
     catch (const std::exception& e) {
         handleAllocationError(e.what());
@@ -124,16 +200,7 @@ bool ResourceManager::checkAvailability(int size) const
         return false;
     }
 
-    int availableCount = 0;
-    for (const auto& block : resourcePool) {
-        if (!block->occupied) {
-            availableCount++;
-            if (availableCount >= size) {
-                return true;
-            }
-        }
-    }
-    return false;
+    return resourcePool.getFreeCount() >= size;
 }
 
 double ResourceManager::getUtilization() const
@@ -141,28 +208,56 @@ double ResourceManager::getUtilization() const
     return currentUtilization;
 }
 
-int ResourceManager::getAvailableBlocks() const
+double ResourceManager::getMeanUtilization() const
 {
-    int count = 0;
-    for (const auto& block : resourcePool) {
-        if (!block->occupied) {
-            count++;
-        }
+    // Time-weighted, so it does not depend on how often the manager is polled
+    simtime_t now = simTime();
+    if (now <= 0) {
+        return currentUtilization;
     }
-    return count;
+    return (utilizationIntegral + currentUtilization * SIMTIME_DBL(now - utilizationSince)) / SIMTIME_DBL(now);
+}
+
+simtime_t ResourceManager::getNextExpiryTime() const
+{
+    int64_t slot = expiryWheel.nextExpirySlot();
+    return slot < 0 ? simtime_t(-1) : slotDuration * static_cast<double>(slot);
+}
+
+int ResourceManager::getAvailableBlocks() const
+{
+    return resourcePool.getFreeCount();
 }
 
 std::vector<int> ResourceManager::getOccupiedResources() const
 {
+    const OccupancyBitmap& occupancy = resourcePool.getOccupancy();
     std::vector<int> occupied;
-    for (const auto& block : resourcePool) {
-        if (block->occupied) {
-            occupied.push_back(block->id);
-        }
+    occupied.reserve(resourcePool.getOccupiedCount());
+    for (int i = occupancy.findFirstSet(); i >= 0; i = occupancy.findFirstSet(i + 1)) {
+        occupied.push_back(i);  // Block ids are pool indices
     }
     return occupied;
 }
 
+size_t ResourceManager::getPoolMemoryFootprint() const
+{
+    return resourcePool.getMemoryFootprint();
+}
+
+size_t ResourceManager::getMemoryFootprint() const
+{
+    // The pool and the sensing engine count themselves, so only their heap storage is added
+    size_t bytes = sizeof(*this);
+    bytes += resourcePool.getMemoryFootprint() - sizeof(resourcePool);
+    bytes += sensing.getMemoryFootprint() - sizeof(sensing);
+    bytes += activeAllocations.getMemoryFootprint();
+    bytes += expiryWheel.getMemoryFootprint();
+    bytes += (expiredScratch.capacity() + batchOrder.capacity() + sensingCandidates.capacity()) * sizeof(int);
+    bytes += candidateMask.capacity() * sizeof(uint8_t);
+    return bytes;
+}
+
 void ResourceManager::setPoolSize(int subch, int symb)
 {
     if (subch <= 0 || symb <= 0) {
@@ -184,6 +279,82 @@ void ResourceManager::setPeriodicity(simtime_t period)
         throw std::invalid_argument("Invalid periodicity value");
     }
     periodicity = period;
+    resizeExpiryWheel();
+}
+
+void ResourceManager::setPreemptionEnabled(bool enabled)
+{
+    if (enabled == preemptionEnabled) {
+        return;
+    }
+    if (!activeAllocations.empty()) {
+        throw std::logic_error("Preemption cannot be toggled while allocations are active");
+    }
+    preemptionEnabled = enabled;
+    resourcePool.setPreemptionLevels(enabled ? NUM_PRIORITY_LEVELS : 0);
+}
+
+void ResourceManager::configureSensing(simtime_t window, double exclusionThresholdDbm, double candidateRatio)
+{
+    if (window <= 0) {
+        throw std::invalid_argument("Invalid sensing window value");
+    }
+    sensingWindow = window;
+    sensing.setSelectionParameters(exclusionThresholdDbm, candidateRatio);
+    
+    // The window needs the subchannel count, so it is sized with the pool
+    if (initialized) {
+        configureSensingWindow();
+    }
+}
+
+void ResourceManager::setSharedSensingView(bool enabled)
+{
+    sharedSensingView = enabled;
+    sensingCandidatesSlot = -1;
+    if (initialized) {
+        configureSensingWindow();
+    }
+}
+
+void ResourceManager::configureSensingWindow()
+{
+    if (sharedSensingView) {
+        sensing.configureView(numSubchannels);
+    }
+    else if (sensingWindow > 0) {
+        sensing.configure(numSubchannels, static_cast<int>(std::ceil(sensingWindow / slotDuration)));
+    }
+}
+
+void ResourceManager::setSensingBasedSelection(bool enabled)
+{
+    sensingBasedSelection = enabled;
+    sensingCandidatesSlot = -1;
+}
+
+void ResourceManager::recordSensingMeasurement(int subchannel, double powerDbm)
+{
+    sensing.addMeasurement(slotIndex(simTime()), subchannel, powerDbm);
+}
+
+void ResourceManager::applySensingView(const std::vector<float>& windowSum, int64_t observedSlots)
+{
+    if (!sensing.isConfigured() || static_cast<int>(windowSum.size()) < numSubchannels) {
+        return;
+    }
+    sensing.selectCandidates(windowSum.data(), observedSlots, sensingCandidates);
+    sensingCandidatesSlot = slotIndex(simTime());
+    markCandidates();
+}
+
+void ResourceManager::setSlotDuration(simtime_t duration)
+{
+    if (duration <= 0) {
+        throw std::invalid_argument("Invalid slot duration value");
+    }
+    slotDuration = duration;
+    resizeExpiryWheel();
 }
 
 bool ResourceManager::initializePool()
@@ -191,19 +362,11 @@ bool ResourceManager::initializePool()
     try {
         validatePoolConfiguration();
         
-        // Create resource blocks
+        // Allocate the pool arrays in one go
         int totalBlocks = numSubchannels * numSymbols;
-        resourcePool.reserve(totalBlocks);
-        
-        for (int i = 0; i < numSubchannels; i++) {
-            for (int j = 0; j < numSymbols; j++) {
-                auto block = std::make_unique<ResourceBlock>();
-                block->id = generateResourceId();
-                block->subchannelIndex = i;
-                block->symbolIndex = j;
-                resourcePool.push_back(std::move(block));
-            }
-        }
+        resourcePool.configure(numSubchannels, numSymbols);
+        configureSensingWindow();
+        sensingCandidatesSlot = -1;
         
         initialized = true;
         EV_INFO << "Resource pool initialized with " << totalBlocks << " blocks" << endl;
@@ -219,122 +382,201 @@ void ResourceManager::clearPool()
 {
     resourcePool.clear();
     activeAllocations.clear();
+    expiryWheel.clear();
+    sensing.clear();
     initialized = false;
 }
 
 bool ResourceManager::validateRequest(int priority, int size) const
 {
-    return (priority >= 0 && size > 0 && size <= numSubchannels * numSymbols);
+    return (priority >= 0 && priority < NUM_PRIORITY_LEVELS &&
+            size > 0 && size <= numSubchannels * numSymbols);
 }
 
-std::vector<ResourceBlock*> ResourceManager::findAvailableBlocks(int size) const
+BlockRange ResourceManager::findAvailableBlocks(int size) const
 {
-    std::vector<ResourceBlock*> available;
+    // First run of at least 'size' consecutive free blocks
+    int first = resourcePool.getFreeExtents().findFirstFit(size);
+    if (first < 0) {
+        return BlockRange();  // Return empty if not enough blocks found
+    }
+    return BlockRange(first, size);
+}
+
+BlockRange ResourceManager::findSensedBlocks(int size)
+{
+    // Rank subchannels at most once per slot; a shared view is ranked when it is applied
+    int64_t slot = slotIndex(simTime());
+    if (slot != sensingCandidatesSlot && sensing.hasWindow()) {
+        sensing.selectCandidates(slot, sensingCandidates);
+        sensingCandidatesSlot = slot;
+        markCandidates();
+    }
     
-    // Find consecutive free blocks
-    for (const auto& block : resourcePool) {
-        if (!block->occupied) {
-            available.push_back(block.get());
-            if (available.size() >= static_cast<size_t>(size)) {
-                return available;
+    // First free run starting inside the best-ranked subchannel that has one
+    const OccupancyBitmap& occupancy = resourcePool.getOccupancy();
+    for (int subchannel : sensingCandidates) {
+        // A run may continue into the following subchannels only while they are candidates too
+        int rowEnd = resourcePool.blockIndex(subchannel + 1, 0);
+        int limit = rowEnd;
+        for (int next = subchannel + 1; next < numSubchannels && candidateMask[next]; next++) {
+            limit = resourcePool.blockIndex(next + 1, 0);
+        }
+        
+        int start = occupancy.findFirstClear(resourcePool.blockIndex(subchannel, 0));
+        while (start >= 0 && start < rowEnd) {
+            int end = occupancy.findFirstSet(start);
+            if (end < 0 || end > limit) {
+                end = limit;
             }
-        } else {
-            available.clear();
+            if (end - start >= size) {
+                return BlockRange(start, size);
+            }
+            start = occupancy.findFirstClear(end);
         }
     }
-    
-    return std::vector<ResourceBlock*>();  // Return empty if not enough blocks found
+    return BlockRange();
 }
 
-void ResourceManager::markBlocksOccupied(const std::vector<ResourceBlock*>& blocks, int priority)
+void ResourceManager::markCandidates()
 {
-    int resourceId = generateResourceId();
-    
-    for (auto block : blocks) {
-        block->occupied = true;
-        block->priority = priority;
-        block->allocTime = simTime();
+    candidateMask.assign(numSubchannels, 0);
+    for (int subchannel : sensingCandidates) {
+        candidateMask[subchannel] = 1;
     }
-    
-    activeAllocations[resourceId] = blocks;
 }
 
-void ResourceManager::cleanExpiredAllocations()
+BlockRange ResourceManager::selectBlocks(int size)
 {
-    simtime_t currentTime = simTime();
-    std::vector<int> expiredIds;
-    
-    // Find expired allocations
-    for (const auto& allocation : activeAllocations) {
-        if (!allocation.second.empty()) {
-            auto firstBlock = allocation.second[0];
-            if (currentTime - firstBlock->allocTime >= periodicity) {
-                expiredIds.push_back(allocation.first);
-            }
+    if (sensingBasedSelection && sensing.isConfigured()) {
+        BlockRange blocks = findSensedBlocks(size);
+        if (!blocks.empty()) {
+            return blocks;
         }
+        // No sensed candidate has room, fall back to plain first fit
+    }
+    return findAvailableBlocks(size);
+}
+
+BlockRange ResourceManager::preemptForRequest(int priority, int size)
+{
+    // Window whose occupants all have the lowest possible priority below ours
+    int victimPriority = -1;
+    int first = resourcePool.findPreemptableRange(priority, size, &victimPriority);
+    if (first < 0) {
+        return BlockRange();
     }
     
-    // Release expired allocations
-    for (int id : expiredIds) {
-        release(id);
+    // Evict every allocation overlapping the window, skipping free stretches
+    BlockRange window(first, size);
+    const OccupancyBitmap& occupancy = resourcePool.getOccupancy();
+    int victims = 0;
+    for (int i = occupancy.findFirstSet(window.first);
+         i >= 0 && i < window.first + window.count;
+         i = occupancy.findFirstSet(i)) {
+        int victimId = resourcePool.getOwner(i);
+        BlockRange victimBlocks = activeAllocations.find(victimId)->blocks;
+        NR_TRACE(slotIndex(simTime()), traceId, TraceEvent::PREEMPT, resourcePool.getPriority(i),
+                 victimBlocks.first, victimBlocks.count);
+        releaseAllocation(victimId);
+        i = victimBlocks.first + victimBlocks.count;
+        victims++;
     }
     
-    lastCleanupTime = currentTime;
+    totalPreemptions += victims;
+    EV_INFO << "Preempted " << victims << " allocations of priority <= " << victimPriority
+            << " for a priority " << priority << " request" << endl;
+    return window;
 }
 
-bool ResourceManager::resolveConflict(const std::vector<ResourceBlock*>& blocks)
+int ResourceManager::markBlocksOccupied(const BlockRange& range, int priority)
 {
-    // Check for overlapping allocations
-    for (auto block1 : blocks) {
-        for (const auto& allocation : activeAllocations) {
-            for (auto block2 : allocation.second) {
-                if (isConflicting(block1, block2)) {
-                    return false;
-                }
-            }
+    int64_t expirySlot = firstSlotAtOrAfter(simTime() + periodicity);
+    int resourceId = activeAllocations.insert(Allocation(range, priority, expirySlot));
+    resourcePool.occupy(range, priority, resourceId, simTime());
+    expiryWheel.schedule(expirySlot, resourceId);
+    NR_TRACE(slotIndex(simTime()), traceId, TraceEvent::ALLOCATE, priority, range.first, range.count);
+    return resourceId;
+}
+
+void ResourceManager::cleanExpiredAllocations()
+{
+    // Only the wheel buckets of the slots elapsed since the last call are visited
+    int64_t slot = slotIndex(simTime());
+    expiredScratch.clear();
+    expiryWheel.advance(slot, expiredScratch);
+    if (expiredScratch.empty()) {
+        return;
+    }
+    
+    for (int id : expiredScratch) {
+        // A stale entry whose handle was reissued must not expire the newer allocation
+        const Allocation* allocation = activeAllocations.find(id);
+        if (allocation && allocation->expirySlot <= slot) {
+            NR_TRACE(slotIndex(simTime()), traceId, TraceEvent::EXPIRE, allocation->priority,
+                     allocation->blocks.first, allocation->blocks.count);
+            releaseAllocation(id);
         }
     }
-    return true;
+    
+    EV_DETAIL << "Expired " << expiredScratch.size() << " allocations" << endl;
+    updateUtilizationStats();
+}
+
+void ResourceManager::releaseAllocation(int resourceId)
+{
+    resourcePool.release(activeAllocations.find(resourceId)->blocks);
+    activeAllocations.erase(resourceId);
 }
 
-bool ResourceManager::isConflicting(const ResourceBlock* block1, const ResourceBlock* block2) const
+int64_t ResourceManager::slotIndex(simtime_t time) const
 {
-    // Check if blocks overlap in time and frequency
-    return (block1->subchannelIndex == block2->subchannelIndex &&
-            block1->symbolIndex == block2->symbolIndex);
+    // Small tolerance so that exact slot boundaries do not round down
+    return static_cast<int64_t>(std::floor(time / slotDuration + 1e-9));
+}
+
+int64_t ResourceManager::firstSlotAtOrAfter(simtime_t time) const
+{
+    return static_cast<int64_t>(std::ceil(time / slotDuration - 1e-9));
+}
+
+void ResourceManager::resizeExpiryWheel()
+{
+    // One turn of the wheel covers a full reservation period
+    int periodSlots = static_cast<int>(std::ceil(periodicity / slotDuration));
+    expiryWheel.resize(std::max(periodSlots + 1, 64));
+}
+
+bool ResourceManager::resolveConflict(const BlockRange& range)
+{
+    // Any occupied block under the candidate range, whole or partial, is a conflict
+    return resourcePool.isRangeFree(range);
 }
 
 void ResourceManager::updateUtilizationStats()
 {
-    int occupiedBlocks = 0;
-    int totalBlocks = resourcePool.size();
+    // Close the interval the previous value held for
+    simtime_t now = simTime();
+    utilizationIntegral += currentUtilization * SIMTIME_DBL(now - utilizationSince);
+    utilizationSince = now;
     
-    for (const auto& block : resourcePool) {
-        if (block->occupied) {
-            occupiedBlocks++;
-        }
-    }
+    int occupiedBlocks = resourcePool.getOccupiedCount();
+    int totalBlocks = resourcePool.size();
     
     currentUtilization = totalBlocks > 0 ? 
         static_cast<double>(occupiedBlocks) / totalBlocks : 0.0;
 }
 
-void ResourceManager::logAllocation(const std::vector<ResourceBlock*>& blocks, int priority)
+void ResourceManager::logAllocation(const BlockRange& range, int priority)
 {
-    EV_INFO << "Allocated " << blocks.size() << " blocks with priority " << priority << endl;
+    EV_INFO << "Allocated " << range.count << " blocks [" << range.first << ", "
+            << range.first + range.count - 1 << "] with priority " << priority << endl;
     logResourceStatus();
 }
 
-int ResourceManager::generateResourceId() const
-{
-    // Simple implementation - could be made more sophisticated
-    static int nextId = 1;
-    return nextId++;
-}
-
 bool ResourceManager::isValidResourceId(int id) const
 {
-    return id > 0 && activeAllocations.find(id) != activeAllocations.end();
+    return activeAllocations.contains(id);
 }
 
 void ResourceManager::validatePoolConfiguration() const
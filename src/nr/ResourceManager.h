@@ -3,8 +3,12 @@
 
 #include <omnetpp.h>
 #include <vector>
-#include <map>
-#include <memory>
+
+#include "ResourcePool.h"
+#include "AllocationTable.h"
+#include "TimingWheel.h"
+#include "SensingEngine.h"
+#include "TraceRing.h"
 
 using namespace omnetpp;
 
@@ -13,19 +17,28 @@ namespace nr {
 class NRModule;  // Forward declaration
 
 /**
- * @brief Structure representing a sidelink resource block
+ * @brief One entry of a per-slot allocation batch
+ *
+ * Larger priority values are served first; equal priorities keep their
+ * submission order.
+ */
+struct AllocationRequest {
+    int priority;            ///< Priority level of the request
+    int size;                ///< Number of contiguous blocks requested
+    
+    AllocationRequest() : priority(0), size(0) {}
+    AllocationRequest(int priority, int size) : priority(priority), size(size) {}
+};
+
+/**
+ * @brief Outcome of one AllocationRequest, at the same position in the batch
  */
-struct ResourceBlock {
-    int id;                  ///< Unique identifier for the resource block
-    int subchannelIndex;     ///< Subchannel index
-    int symbolIndex;         ///< Symbol index
-    bool occupied;           ///< Occupation status
-    int priority;            ///< Priority level of current allocation
-    simtime_t allocTime;     ///< Time when the resource was allocated
-    
-    ResourceBlock() : 
-        id(0), subchannelIndex(0), symbolIndex(0), 
-        occupied(false), priority(0), allocTime(0) {}
+struct AllocationResult {
+    int resourceId;          ///< Handle of the granted allocation, 0 if none
+    BlockRange blocks;       ///< Granted blocks, empty on failure
+    
+    AllocationResult() : resourceId(0) {}
+    bool granted() const { return resourceId > 0; }
 };
 
 /**
@@ -43,64 +56,110 @@ class ResourceManager
     
     // Resource allocation interface
     bool allocateResources();
-    bool allocateSpecific(int priority, int size);
+    bool allocateSpecific(int priority, int size, AllocationResult* result = nullptr);
+    int allocateBatch(const std::vector<AllocationRequest>& requests, std::vector<AllocationResult>& results);
     void release(int resourceId);
     bool checkAvailability(int size) const;
     
     // Status queries
     double getUtilization() const;
+    double getMeanUtilization() const;
     int getAvailableBlocks() const;
     std::vector<int> getOccupiedResources() const;
+    size_t getPoolMemoryFootprint() const;
+    size_t getMemoryFootprint() const;
+    int getTotalAllocations() const { return totalAllocations; }
+    int getFailedAllocations() const { return failedAllocations; }
+    int getTotalPreemptions() const { return totalPreemptions; }
+    size_t getSensingMemoryFootprint() const { return sensing.getMemoryFootprint(); }
+    simtime_t getNextExpiryTime() const;
+    int getNumSubchannels() const { return numSubchannels; }
+    int getNumSymbols() const { return numSymbols; }
+    bool isSensingBasedSelection() const { return sensingBasedSelection; }
     
     // Configuration
     void setPoolSize(int numSubchannels, int numSymbols);
     void setPeriodicity(simtime_t period);
+    void setSlotDuration(simtime_t duration);
+    void setPreemptionEnabled(bool enabled);
+    void configureSensing(simtime_t window, double exclusionThresholdDbm, double candidateRatio);
+    void setSensingBasedSelection(bool enabled);
+    void setSharedSensingView(bool enabled);
+    
+    // Sensing input
+    void recordSensingMeasurement(int subchannel, double powerDbm);
+    void applySensingView(const std::vector<float>& windowSum, int64_t observedSlots);
     
   protected:
     // Internal utility functions
     bool initializePool();
     void clearPool();
     bool validateRequest(int priority, int size) const;
-    std::vector<ResourceBlock*> findAvailableBlocks(int size) const;
-    void markBlocksOccupied(const std::vector<ResourceBlock*>& blocks, int priority);
+    BlockRange findAvailableBlocks(int size) const;
+    BlockRange findSensedBlocks(int size);
+    BlockRange selectBlocks(int size);
+    BlockRange preemptForRequest(int priority, int size);
+    int markBlocksOccupied(const BlockRange& range, int priority);
     void cleanExpiredAllocations();
+    void releaseAllocation(int resourceId);
+    int64_t slotIndex(simtime_t time) const;
+    int64_t firstSlotAtOrAfter(simtime_t time) const;
+    void resizeExpiryWheel();
+    void configureSensingWindow();
+    void markCandidates();
     
     // Conflict resolution
-    bool resolveConflict(const std::vector<ResourceBlock*>& blocks);
-    bool isConflicting(const ResourceBlock* block1, const ResourceBlock* block2) const;
+    bool resolveConflict(const BlockRange& range);
     
     // Monitoring and statistics
     void updateUtilizationStats();
-    void logAllocation(const std::vector<ResourceBlock*>& blocks, int priority);
+    void logAllocation(const BlockRange& range, int priority);
     
   private:
     // Parent module reference
     NRModule* parentModule;
+    int traceId;                        ///< Module id of the parent, used in trace records
     
     // Resource pool configuration
     int numSubchannels;
     int numSymbols;
     simtime_t periodicity;
+    simtime_t slotDuration;
     
     // Resource management
-    std::vector<std::unique_ptr<ResourceBlock>> resourcePool;
-    std::map<int, std::vector<ResourceBlock*>> activeAllocations;
+    ResourcePool resourcePool;
+    AllocationTable activeAllocations; ///< Generational handles are the resource ids
+    TimingWheel expiryWheel;          ///< Allocation ids keyed by expiry slot
+    std::vector<int> expiredScratch;  ///< Reused output buffer for the wheel
+    std::vector<int> batchOrder;      ///< Reused priority order for allocateBatch
+    
+    // Sensing-based selection (Mode 2 / Mode 4)
+    SensingEngine sensing;
+    simtime_t sensingWindow;            ///< 0 when sensing is not configured
+    bool sensingBasedSelection;
+    bool sharedSensingView;             ///< Window kept by a ChannelOccupancyStore, not here
+    std::vector<int> sensingCandidates; ///< Ranked subchannels, refreshed once per slot
+    std::vector<uint8_t> candidateMask; ///< 1 for each subchannel in sensingCandidates
+    int64_t sensingCandidatesSlot;
     
     // Statistics
     double currentUtilization;
+    double utilizationIntegral;         ///< Utilization integrated over time up to utilizationSince
+    simtime_t utilizationSince;
     int totalAllocations;
     int failedAllocations;
+    int totalPreemptions;
     
     // Internal state
     bool initialized;
-    simtime_t lastCleanupTime;
+    bool preemptionEnabled;
     
     // Constants
     static const int MAX_RETRIES = 3;
-    static const simtime_t CLEANUP_INTERVAL;
+    static const int NUM_PRIORITY_LEVELS = 8;   ///< Valid priorities are 0..7, larger is more important
+    static const simtime_t DEFAULT_SLOT_DURATION;
     
     // Utility functions
-    int generateResourceId() const;
     bool isValidResourceId(int id) const;
     void validatePoolConfiguration() const;
     
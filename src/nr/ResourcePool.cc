@@ -0,0 +1,160 @@
+#include "ResourcePool.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace nr {
+
+ResourcePool::ResourcePool() :
+    numSubchannels(0),
+    numSymbols(0),
+    occupiedCount(0),
+    numPriorityLevels(0)
+{
+}
+
+void ResourcePool::configure(int subch, int symb)
+{
+    if (subch <= 0 || symb <= 0) {
+        throw std::invalid_argument("ResourcePool: invalid pool dimensions");
+    }
+
+    numSubchannels = subch;
+    numSymbols = symb;
+
+    int totalBlocks = subch * symb;
+    occupancy.resize(totalBlocks);
+    freeExtents.reset(totalBlocks);
+    priority.assign(totalBlocks, 0);
+    allocTime.assign(totalBlocks, SIMTIME_ZERO);
+    owner.assign(totalBlocks, 0);
+    occupiedCount = 0;
+    resetPreemptionLevels();
+}
+
+void ResourcePool::setPreemptionLevels(int levels)
+{
+    if (levels < 0) {
+        throw std::invalid_argument("ResourcePool: negative number of priority levels");
+    }
+    if (occupiedCount > 0) {
+        throw std::logic_error("ResourcePool: cannot change preemption levels while blocks are occupied");
+    }
+    numPriorityLevels = levels;
+    resetPreemptionLevels();
+}
+
+void ResourcePool::resetPreemptionLevels()
+{
+    // The top level would admit every block, so it is never built
+    int indexCount = numPriorityLevels > 1 ? numPriorityLevels - 1 : 0;
+    preemptionLevels.resize(indexCount);
+    for (auto& level : preemptionLevels) {
+        level.reset(size());
+    }
+}
+
+void ResourcePool::clear()
+{
+    numSubchannels = 0;
+    numSymbols = 0;
+    occupiedCount = 0;
+    occupancy.resize(0);
+    freeExtents.reset(0);
+    priority.clear();
+    allocTime.clear();
+    owner.clear();
+    resetPreemptionLevels();
+}
+
+void ResourcePool::occupy(const BlockRange& range, int prio, int ownerId, simtime_t now)
+{
+    if (range.first < 0 || range.first + range.count > size()) {
+        throw std::out_of_range("ResourcePool: range outside pool");
+    }
+
+    // Blocks stop being preemptable for every level below their priority
+    int levels = std::min(prio, static_cast<int>(preemptionLevels.size()));
+    for (int q = 0; q < levels; q++) {
+        preemptionLevels[q].markOccupied(range.first, range.count);
+    }
+
+    std::fill(priority.begin() + range.first, priority.begin() + range.first + range.count, prio);
+    std::fill(allocTime.begin() + range.first, allocTime.begin() + range.first + range.count, now);
+    std::fill(owner.begin() + range.first, owner.begin() + range.first + range.count, ownerId);
+    occupancy.setRange(range.first, range.count);
+    freeExtents.markOccupied(range.first, range.count);
+    occupiedCount += range.count;
+}
+
+void ResourcePool::release(const BlockRange& range)
+{
+    if (range.first < 0 || range.first + range.count > size()) {
+        throw std::out_of_range("ResourcePool: range outside pool");
+    }
+
+    // A range always belongs to one allocation, so its first block carries the priority
+    int levels = range.count > 0 ? std::min(priority[range.first], static_cast<int>(preemptionLevels.size())) : 0;
+    for (int q = 0; q < levels; q++) {
+        preemptionLevels[q].markFree(range.first, range.count);
+    }
+
+    std::fill(priority.begin() + range.first, priority.begin() + range.first + range.count, 0);
+    std::fill(allocTime.begin() + range.first, allocTime.begin() + range.first + range.count, SIMTIME_ZERO);
+    std::fill(owner.begin() + range.first, owner.begin() + range.first + range.count, 0);
+    occupancy.resetRange(range.first, range.count);
+    freeExtents.markFree(range.first, range.count);
+    occupiedCount -= range.count;
+}
+
+bool ResourcePool::isRangeFree(const BlockRange& range) const
+{
+    if (range.first < 0 || range.first + range.count > size()) {
+        return false;
+    }
+    return !occupancy.anyInRange(range.first, range.count);
+}
+
+int ResourcePool::findPreemptableRange(int prio, int count, int* maxVictimPriority) const
+{
+    // Lowest level first: the window found evicts the least important victims
+    int levels = std::min(prio, static_cast<int>(preemptionLevels.size()));
+    for (int q = 0; q < levels; q++) {
+        int first = preemptionLevels[q].findFirstFit(count);
+        if (first >= 0) {
+            if (maxVictimPriority) {
+                *maxVictimPriority = q;
+            }
+            return first;
+        }
+    }
+    return -1;
+}
+
+ResourceBlock ResourcePool::getBlock(int index) const
+{
+    ResourceBlock block;
+    block.id = index;
+    block.subchannelIndex = subchannelOf(index);
+    block.symbolIndex = symbolOf(index);
+    block.occupied = isOccupied(index);
+    block.priority = priority[index];
+    block.allocTime = allocTime[index];
+    return block;
+}
+
+size_t ResourcePool::getMemoryFootprint() const
+{
+    // Heap storage behind the arrays plus the pool object itself
+    size_t bytes = sizeof(*this);
+    bytes += occupancy.wordCount() * sizeof(OccupancyBitmap::Word);
+    bytes += freeExtents.getMemoryFootprint();
+    bytes += priority.capacity() * sizeof(int);
+    bytes += allocTime.capacity() * sizeof(simtime_t);
+    bytes += owner.capacity() * sizeof(int);
+    for (const auto& level : preemptionLevels) {
+        bytes += sizeof(level) + level.getMemoryFootprint();
+    }
+    return bytes;
+}
+
+}  // namespace nr
\ No newline at end of file
@@ -0,0 +1,118 @@
+#ifndef __RESOURCE_POOL_H
+#define __RESOURCE_POOL_H
+
+#include <omnetpp.h>
+#include <vector>
+#include <cstddef>
+
+#include "OccupancyBitmap.h"
+#include "FreeExtentIndex.h"
+
+using namespace omnetpp;
+
+namespace nr {
+
+/**
+ * @brief Structure representing a sidelink resource block
+ *
+ * The pool no longer stores blocks as objects; this is a value view
+ * assembled from the pool arrays by ResourcePool::getBlock().
+ */
+struct ResourceBlock {
+    int id;                  ///< Unique identifier for the resource block (its pool index)
+    int subchannelIndex;     ///< Subchannel index
+    int symbolIndex;         ///< Symbol index
+    bool occupied;           ///< Occupation status
+    int priority;            ///< Priority level of current allocation
+    simtime_t allocTime;     ///< Time when the resource was allocated
+
+    ResourceBlock() :
+        id(0), subchannelIndex(0), symbolIndex(0),
+        occupied(false), priority(0), allocTime(0) {}
+};
+
+/**
+ * @brief Contiguous run of blocks in the resource pool
+ */
+struct BlockRange {
+    int first;               ///< Pool index of the first block
+    int count;               ///< Number of blocks, 0 for an empty range
+
+    BlockRange() : first(-1), count(0) {}
+    BlockRange(int first, int count) : first(first), count(count) {}
+    bool empty() const { return count <= 0; }
+};
+
+/**
+ * @brief Flat structure-of-arrays storage for the sidelink resource pool
+ *
+ * Blocks are addressed by index (subchannel-major, like the original pool)
+ * and their state lives in parallel arrays: the occupancy bitmap, the
+ * allocation priority and the allocation time. The free-extent index is
+ * kept in step with the bitmap so first-fit searches never touch the arrays.
+ *
+ * When preemption levels are enabled, one extra extent index per priority
+ * level q tracks the blocks that are free or held at priority <= q. A
+ * request of priority p then finds the first window it could take over by
+ * evicting only lower priorities with one O(log n) query per level.
+ */
+class ResourcePool
+{
+  public:
+    ResourcePool();
+
+    // Configuration
+    void configure(int numSubchannels, int numSymbols);
+    void setPreemptionLevels(int numPriorityLevels);
+    void clear();
+
+    // Geometry
+    int size() const { return occupancy.size(); }
+    int getNumSubchannels() const { return numSubchannels; }
+    int getNumSymbols() const { return numSymbols; }
+    int blockIndex(int subchannel, int symbol) const { return subchannel * numSymbols + symbol; }
+    int subchannelOf(int index) const { return index / numSymbols; }
+    int symbolOf(int index) const { return index % numSymbols; }
+
+    // State changes
+    void occupy(const BlockRange& range, int priority, int owner, simtime_t now);
+    void release(const BlockRange& range);
+
+    // Per-block queries
+    bool isOccupied(int index) const { return occupancy.test(index); }
+    int getPriority(int index) const { return priority[index]; }
+    int getOwner(int index) const { return owner[index]; }
+    simtime_t getAllocTime(int index) const { return allocTime[index]; }
+    ResourceBlock getBlock(int index) const;
+
+    // Conflict checks against the occupancy grid
+    bool isRangeFree(const BlockRange& range) const;
+    int findPreemptableRange(int priority, int size, int* maxVictimPriority) const;
+
+    // Pool-wide queries
+    int getOccupiedCount() const { return occupiedCount; }
+    int getFreeCount() const { return size() - occupiedCount; }
+    const OccupancyBitmap& getOccupancy() const { return occupancy; }
+    const FreeExtentIndex& getFreeExtents() const { return freeExtents; }
+    size_t getMemoryFootprint() const;
+
+  private:
+    int numSubchannels;
+    int numSymbols;
+    int occupiedCount;
+
+    OccupancyBitmap occupancy;           ///< Occupation status, one bit per block
+    FreeExtentIndex freeExtents;         ///< Free-run index over the same blocks
+    std::vector<int> priority;           ///< Priority of the current allocation
+    std::vector<simtime_t> allocTime;    ///< Time the current allocation was made
+    std::vector<int> owner;              ///< Resource id holding the block, 0 if free
+
+    int numPriorityLevels;                         ///< 0 when preemption indexes are disabled
+    std::vector<FreeExtentIndex> preemptionLevels; ///< Level q: free or priority <= q
+
+    void resetPreemptionLevels();
+};
+
+}  // namespace nr
+
+#endif // __RESOURCE_POOL_H
\ No newline at end of file
@@ -0,0 +1,218 @@
+#include "SensingEngine.h"
+#include "SensingKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace nr {
+
+SensingEngine::SensingEngine() :
+    numSubchannels(0),
+    windowSlots(0),
+    exclusionThresholdDbm(-110.0),
+    candidateRatio(0.2),
+    currentSlot(-1),
+    firstSlot(-1)
+{
+}
+
+void SensingEngine::configure(int subchannels, int slots)
+{
+    if (subchannels <= 0 || slots <= 0) {
+        throw std::invalid_argument("SensingEngine: invalid window dimensions");
+    }
+
+    numSubchannels = subchannels;
+    windowSlots = slots;
+    ring.assign(static_cast<size_t>(slots) * subchannels, 0.0f);
+    windowSum.assign(subchannels, 0.0f);
+    average.assign(subchannels, 0.0f);
+    excluded.assign(subchannels, 0);
+    keep.assign(subchannels, 0);
+    ranking.reserve(subchannels);
+    currentSlot = -1;
+    firstSlot = -1;
+}
+
+void SensingEngine::configureView(int subchannels)
+{
+    if (subchannels <= 0) {
+        throw std::invalid_argument("SensingEngine: invalid number of subchannels");
+    }
+
+    // Scratch space for ranking only, the window itself lives elsewhere
+    numSubchannels = subchannels;
+    windowSlots = 0;
+    ring.clear();
+    ring.shrink_to_fit();
+    windowSum.clear();
+    windowSum.shrink_to_fit();
+    average.assign(subchannels, 0.0f);
+    excluded.assign(subchannels, 0);
+    keep.assign(subchannels, 0);
+    ranking.reserve(subchannels);
+    currentSlot = -1;
+    firstSlot = -1;
+}
+
+void SensingEngine::setSelectionParameters(double thresholdDbm, double ratio)
+{
+    if (ratio <= 0 || ratio > 1) {
+        throw std::invalid_argument("SensingEngine: candidate ratio must be in (0, 1]");
+    }
+    exclusionThresholdDbm = thresholdDbm;
+    candidateRatio = ratio;
+}
+
+void SensingEngine::clear()
+{
+    std::fill(ring.begin(), ring.end(), 0.0f);
+    std::fill(windowSum.begin(), windowSum.end(), 0.0f);
+    currentSlot = -1;
+    firstSlot = -1;
+}
+
+void SensingEngine::addMeasurement(int64_t slot, int subchannel, double powerDbm)
+{
+    if (!hasWindow() || subchannel < 0 || subchannel >= numSubchannels) {
+        return;
+    }
+
+    advanceTo(slot);
+    if (slot < currentSlot) {
+        return;  // Older than the newest row, nothing sensible to update
+    }
+
+    float milliwatts = static_cast<float>(std::pow(10.0, powerDbm / 10.0));
+    row(slot)[subchannel] += milliwatts;
+    windowSum[subchannel] += milliwatts;
+}
+
+void SensingEngine::advanceTo(int64_t slot)
+{
+    if (!hasWindow()) {
+        return;
+    }
+    if (currentSlot < 0) {
+        currentSlot = slot;
+        firstSlot = slot;
+        return;
+    }
+    if (slot <= currentSlot) {
+        return;
+    }
+
+    // A gap longer than the window empties it completely
+    if (slot - currentSlot >= windowSlots) {
+        std::fill(ring.begin(), ring.end(), 0.0f);
+        std::fill(windowSum.begin(), windowSum.end(), 0.0f);
+        currentSlot = slot;
+        return;
+    }
+
+    // Drop the rows that fall out of the window as it slides
+    for (int64_t s = currentSlot + 1; s <= slot; s++) {
+        float* oldest = row(s);
+        sensing::subtract(windowSum.data(), oldest, numSubchannels);
+        std::fill(oldest, oldest + numSubchannels, 0.0f);
+
+        // Re-sum once per turn so float rounding in the running sums cannot build up
+        if (s % windowSlots == 0) {
+            recomputeSums();
+        }
+    }
+    currentSlot = slot;
+}
+
+int SensingEngine::selectCandidates(int64_t slot, std::vector<int>& candidates)
+{
+    if (!hasWindow()) {
+        candidates.clear();
+        return 0;
+    }
+
+    advanceTo(slot);
+    int64_t observed = hasMeasurements() ? std::min<int64_t>(currentSlot - firstSlot + 1, windowSlots) : 0;
+    return rankCandidates(windowSum.data(), observed, candidates);
+}
+
+int SensingEngine::selectCandidates(const float* sums, int64_t observedSlots, std::vector<int>& candidates)
+{
+    if (!isConfigured()) {
+        candidates.clear();
+        return 0;
+    }
+    return rankCandidates(sums, observedSlots, candidates);
+}
+
+int SensingEngine::rankCandidates(const float* sums, int64_t observed, std::vector<int>& candidates)
+{
+    candidates.clear();
+    if (observed <= 0) {
+        // Nothing sensed yet, every subchannel is as good as any other
+        for (int i = 0; i < numSubchannels; i++) {
+            candidates.push_back(i);
+        }
+        return numSubchannels;
+    }
+
+    // Average over the part of the window that has been observed
+    sensing::scale(average.data(), sums, 1.0f / observed, numSubchannels);
+
+    // Exclude busy subchannels, relaxing the threshold by 3 dB until enough remain
+    int required = std::max(1, static_cast<int>(std::ceil(candidateRatio * numSubchannels)));
+    double thresholdDbm = exclusionThresholdDbm;
+    int remaining = 0;
+    for (int step = 0; step <= MAX_THRESHOLD_STEPS; step++, thresholdDbm += 3.0) {
+        float threshold = static_cast<float>(std::pow(10.0, thresholdDbm / 10.0));
+        remaining = sensing::excludeAbove(average.data(), threshold, excluded.data(), numSubchannels);
+        if (remaining >= required) {
+            break;
+        }
+    }
+    if (remaining == 0) {
+        return 0;
+    }
+
+    // Bottom fraction by average power among the survivors
+    int target = std::min(required, remaining);
+    ranking.clear();
+    for (int i = 0; i < numSubchannels; i++) {
+        if (!excluded[i]) {
+            ranking.push_back(average[i]);
+        }
+    }
+    std::nth_element(ranking.begin(), ranking.begin() + (target - 1), ranking.end());
+    float cutoff = ranking[target - 1];
+    sensing::keepAtOrBelow(average.data(), cutoff, excluded.data(), keep.data(), numSubchannels);
+
+    for (int i = 0; i < numSubchannels; i++) {
+        if (keep[i]) {
+            candidates.push_back(i);
+        }
+    }
+    const std::vector<float>& avg = average;
+    std::sort(candidates.begin(), candidates.end(), [&avg](int a, int b) {
+        return avg[a] != avg[b] ? avg[a] < avg[b] : a < b;
+    });
+    return static_cast<int>(candidates.size());
+}
+
+size_t SensingEngine::getMemoryFootprint() const
+{
+    size_t bytes = sizeof(*this);
+    bytes += ring.capacity() * sizeof(float);
+    bytes += (windowSum.capacity() + average.capacity() + ranking.capacity()) * sizeof(float);
+    bytes += (excluded.capacity() + keep.capacity()) * sizeof(uint8_t);
+    return bytes;
+}
+
+void SensingEngine::recomputeSums()
+{
+    std::fill(windowSum.begin(), windowSum.end(), 0.0f);
+    for (int r = 0; r < windowSlots; r++) {
+        sensing::accumulate(windowSum.data(), &ring[static_cast<size_t>(r) * numSubchannels], numSubchannels);
+    }
+}
+
+}  // namespace nr
\ No newline at end of file
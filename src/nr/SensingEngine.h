@@ -0,0 +1,75 @@
+#ifndef __SENSING_ENGINE_H
+#define __SENSING_ENGINE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace nr {
+
+/**
+ * @brief Sensing window and candidate ranking for Mode 2 / Mode 4 selection
+ *
+ * Received power per subchannel is kept in a ring of windowSlots rows,
+ * each row holding one float (mW) per subchannel, together with running
+ * per-subchannel window sums. Candidate selection follows the usual
+ * sidelink procedure: average over the window, exclude subchannels above
+ * the RSRP threshold (raising it by 3 dB until enough remain) and keep
+ * the bottom fraction by average power. The per-slot and per-selection
+ * work is done by the kernels in SensingKernels.h.
+ *
+ * When the window is kept elsewhere (see ChannelOccupancyStore) the engine
+ * is configured without a ring and only ranks the window sums handed in.
+ */
+class SensingEngine
+{
+  public:
+    SensingEngine();
+
+    // Configuration
+    void configure(int numSubchannels, int windowSlots);
+    void configureView(int numSubchannels);
+    void setSelectionParameters(double exclusionThresholdDbm, double candidateRatio);
+    void clear();
+    bool isConfigured() const { return numSubchannels > 0; }
+    bool hasWindow() const { return windowSlots > 0; }
+    int getNumSubchannels() const { return numSubchannels; }
+    int getWindowSlots() const { return windowSlots; }
+
+    // Measurement input
+    void addMeasurement(int64_t slot, int subchannel, double powerDbm);
+    void advanceTo(int64_t slot);
+    bool hasMeasurements() const { return firstSlot >= 0; }
+
+    // Candidate selection, best (lowest average power) first
+    int selectCandidates(int64_t slot, std::vector<int>& candidates);
+    int selectCandidates(const float* windowSum, int64_t observedSlots, std::vector<int>& candidates);
+
+    size_t getMemoryFootprint() const;
+
+  private:
+    int numSubchannels;
+    int windowSlots;
+    double exclusionThresholdDbm;
+    double candidateRatio;
+
+    std::vector<float> ring;        ///< windowSlots x numSubchannels, row-major, mW
+    std::vector<float> windowSum;   ///< Running sum over the window per subchannel
+    std::vector<float> average;     ///< Scratch: window average per subchannel
+    std::vector<uint8_t> excluded;  ///< Scratch: excluded by the RSRP threshold
+    std::vector<uint8_t> keep;      ///< Scratch: kept after bottom-fraction selection
+    std::vector<float> ranking;     ///< Scratch: values used to find the cutoff
+
+    int64_t currentSlot;            ///< Newest slot in the ring, -1 before the first sample
+    int64_t firstSlot;              ///< First slot ever measured, -1 before the first sample
+
+    static const int MAX_THRESHOLD_STEPS = 20;
+
+    float* row(int64_t slot) { return &ring[(slot % windowSlots) * numSubchannels]; }
+    int rankCandidates(const float* sums, int64_t observedSlots, std::vector<int>& candidates);
+    void recomputeSums();
+};
+
+}  // namespace nr
+
+#endif // __SENSING_ENGINE_H
\ No newline at end of file
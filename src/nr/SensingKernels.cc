@@ -0,0 +1,95 @@
+#include "SensingKernels.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define NR_SENSING_SSE 1
+#endif
+
+namespace nr {
+namespace sensing {
+
+void accumulate(float* acc, const float* row, int n)
+{
+    int i = 0;
+#ifdef NR_SENSING_SSE
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_loadu_ps(row + i)));
+    }
+#endif
+    for (; i < n; i++) {
+        acc[i] += row[i];
+    }
+}
+
+void subtract(float* acc, const float* row, int n)
+{
+    int i = 0;
+#ifdef NR_SENSING_SSE
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(acc + i, _mm_sub_ps(_mm_loadu_ps(acc + i), _mm_loadu_ps(row + i)));
+    }
+#endif
+    for (; i < n; i++) {
+        acc[i] -= row[i];
+    }
+}
+
+void scale(float* out, const float* in, float factor, int n)
+{
+    int i = 0;
+#ifdef NR_SENSING_SSE
+    __m128 f = _mm_set1_ps(factor);
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(in + i), f));
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = in[i] * factor;
+    }
+}
+
+int excludeAbove(const float* values, float threshold, uint8_t* excluded, int n)
+{
+    int kept = 0;
+    int i = 0;
+#ifdef NR_SENSING_SSE
+    __m128 t = _mm_set1_ps(threshold);
+    for (; i + 4 <= n; i += 4) {
+        int bits = _mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(values + i), t));
+        excluded[i] = bits & 1;
+        excluded[i + 1] = (bits >> 1) & 1;
+        excluded[i + 2] = (bits >> 2) & 1;
+        excluded[i + 3] = (bits >> 3) & 1;
+        kept += 4 - __builtin_popcount(bits);
+    }
+#endif
+    for (; i < n; i++) {
+        excluded[i] = values[i] > threshold;
+        kept += !excluded[i];
+    }
+    return kept;
+}
+
+int keepAtOrBelow(const float* values, float cutoff, const uint8_t* excluded, uint8_t* keep, int n)
+{
+    int kept = 0;
+    int i = 0;
+#ifdef NR_SENSING_SSE
+    __m128 c = _mm_set1_ps(cutoff);
+    for (; i + 4 <= n; i += 4) {
+        int bits = _mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(values + i), c));
+        for (int k = 0; k < 4; k++) {
+            keep[i + k] = ((bits >> k) & 1) && !excluded[i + k];
+            kept += keep[i + k];
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        keep[i] = values[i] <= cutoff && !excluded[i];
+        kept += keep[i];
+    }
+    return kept;
+}
+
+}  // namespace sensing
+}  // namespace nr
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef __SENSING_KERNELS_H
+#define __SENSING_KERNELS_H
+
+#include <cstdint>
+
+namespace nr {
+namespace sensing {
+
+/**
+ * @brief Vector kernels used by SensingEngine
+ *
+ * All kernels work on contiguous float arrays of length n. They use SSE
+ * when the compiler targets it (always the case on x86-64) and fall back
+ * to plain loops elsewhere. Arrays need no particular alignment.
+ */
+
+/// acc[i] += row[i]
+void accumulate(float* acc, const float* row, int n);
+
+/// acc[i] -= row[i]
+void subtract(float* acc, const float* row, int n);
+
+/// out[i] = in[i] * factor, used to turn window sums into averages
+void scale(float* out, const float* in, float factor, int n);
+
+/// excluded[i] = (values[i] > threshold); returns the number of values kept
+int excludeAbove(const float* values, float threshold, uint8_t* excluded, int n);
+
+/// keep[i] = !excluded[i] && values[i] <= cutoff; returns the number of values kept
+int keepAtOrBelow(const float* values, float cutoff, const uint8_t* excluded, uint8_t* keep, int n);
+
+}  // namespace sensing
+}  // namespace nr
+
+#endif // __SENSING_KERNELS_H
\ No newline at end of file
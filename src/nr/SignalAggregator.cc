@@ -0,0 +1,106 @@
+#include "SignalAggregator.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace nr {
+
+SignalAggregator::SignalAggregator() :
+    count(0),
+    sum(0),
+    min(0),
+    max(0),
+    histogramMin(0),
+    bucketWidth(1),
+    underflow(0),
+    overflow(0)
+{
+}
+
+void SignalAggregator::configure(double lower, double upper, int numBuckets)
+{
+    if (numBuckets <= 0 || !(upper > lower)) {
+        throw std::invalid_argument("SignalAggregator: invalid histogram range");
+    }
+    histogramMin = lower;
+    bucketWidth = (upper - lower) / numBuckets;
+    buckets.assign(numBuckets, 0);
+    reset();
+}
+
+void SignalAggregator::reset()
+{
+    count = 0;
+    sum = 0;
+    min = 0;
+    max = 0;
+    std::fill(buckets.begin(), buckets.end(), 0);
+    underflow = 0;
+    overflow = 0;
+}
+
+void SignalAggregator::add(double value, long weight)
+{
+    // A weight stands for that many copies of the sample
+    if (weight <= 0) {
+        return;
+    }
+    if (count == 0) {
+        min = max = value;
+    }
+    else {
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+    count += weight;
+    sum += value * weight;
+
+    if (buckets.empty()) {
+        return;
+    }
+    // The last bucket includes its upper edge, so a range of [0, 1] keeps 1 in range
+    double position = std::floor((value - histogramMin) / bucketWidth);
+    double numBuckets = static_cast<double>(buckets.size());
+    if (position < 0) {
+        underflow += weight;
+    }
+    else if (position >= numBuckets) {
+        if (value <= histogramMin + numBuckets * bucketWidth) {
+            buckets.back() += weight;
+        }
+        else {
+            overflow += weight;
+        }
+    }
+    else {
+        buckets[static_cast<size_t>(position)] += weight;
+    }
+}
+
+void SignalAggregator::merge(const SignalAggregator& other)
+{
+    if (other.count == 0) {
+        return;
+    }
+    if (other.buckets.size() != buckets.size()) {
+        throw std::invalid_argument("SignalAggregator: merging histograms of different shapes");
+    }
+
+    if (count == 0) {
+        min = other.min;
+        max = other.max;
+    }
+    else {
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+    count += other.count;
+    sum += other.sum;
+    for (size_t i = 0; i < buckets.size(); i++) {
+        buckets[i] += other.buckets[i];
+    }
+    underflow += other.underflow;
+    overflow += other.overflow;
+}
+
+}  // namespace nr
\ No newline at end of file
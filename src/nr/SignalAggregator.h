@@ -0,0 +1,61 @@
+#ifndef __SIGNAL_AGGREGATOR_H
+#define __SIGNAL_AGGREGATOR_H
+
+#include <cstddef>
+#include <vector>
+
+namespace nr {
+
+/**
+ * @brief Running summary of a stream of samples
+ *
+ * Keeps count, sum, minimum and maximum and a histogram with equal-width
+ * buckets over [histogramMin, histogramMax], plus underflow and overflow
+ * counters. Adding a sample is O(1) and allocation-free, so per-slot
+ * values can be summarised in the module and emitted once per window
+ * instead of being handed to the recorders one by one.
+ */
+class SignalAggregator
+{
+  public:
+    SignalAggregator();
+
+    // Configuration
+    void configure(double histogramMin, double histogramMax, int numBuckets);
+    void reset();
+
+    // Samples
+    void add(double value, long weight = 1);
+    void merge(const SignalAggregator& other);
+
+    // Summary
+    bool empty() const { return count == 0; }
+    long getCount() const { return count; }
+    double getSum() const { return sum; }
+    double getMean() const { return count > 0 ? sum / count : 0.0; }
+    double getMin() const { return min; }
+    double getMax() const { return max; }
+
+    // Histogram
+    int getNumBuckets() const { return static_cast<int>(buckets.size()); }
+    double getBucketLowerBound(int bucket) const { return histogramMin + bucket * bucketWidth; }
+    long getBucketCount(int bucket) const { return buckets[bucket]; }
+    long getUnderflow() const { return underflow; }
+    long getOverflow() const { return overflow; }
+
+  private:
+    long count;
+    double sum;
+    double min;
+    double max;
+
+    double histogramMin;
+    double bucketWidth;
+    std::vector<long> buckets;
+    long underflow;
+    long overflow;
+};
+
+}  // namespace nr
+
+#endif // __SIGNAL_AGGREGATOR_H
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "SlotClock.h"
+#include <algorithm>
+#include <cmath>
+
+namespace nr {
+
+Define_Module(SlotClock);
+
+SlotClock::SlotClock() :
+    slotDuration(0),
+    subscriptions(256),
+    currentSlot(-1),
+    tickTimer(nullptr),
+    totalTicks(0),
+    totalCalls(0)
+{
+}
+
+SlotClock::~SlotClock()
+{
+    cancelAndDelete(tickTimer);
+}
+
+void SlotClock::initialize()
+{
+    slotDuration = par("slotDuration");
+    if (slotDuration <= 0) {
+        throw cRuntimeError("Invalid slot duration %f", SIMTIME_DBL(slotDuration));
+    }
+    
+    tickTimer = new cMessage("slotTick");
+    tickTimer->setSchedulingPriority(1);  // Listeners see the requests made at the slot start
+    
+    WATCH(totalTicks);
+    WATCH(totalCalls);
+}
+
+void SlotClock::handleMessage(cMessage *msg)
+{
+    if (msg != tickTimer) {
+        throw cRuntimeError("SlotClock does not process messages");
+    }
+    
+    processSlot();
+    
+    // Sleep until the earliest slot somebody asked for
+    int64_t next = subscriptions.nextExpirySlot();
+    if (next >= 0) {
+        scheduleTick(next);
+    }
+}
+
+void SlotClock::finish()
+{
+    recordScalar("slotTicks", totalTicks);
+    recordScalar("slotListenerCalls", totalCalls);
+}
+
+void SlotClock::processSlot()
+{
+    currentSlot = std::max(currentSlot + 1, slotAt(simTime()));
+    dueScratch.clear();
+    subscriptions.advance(currentSlot, dueScratch);
+    totalTicks++;
+    
+    // Deterministic call order, one call per listener
+    const std::vector<Listener>& registered = listeners;
+    std::sort(dueScratch.begin(), dueScratch.end(), [&registered](int a, int b) {
+        return registered[a].key != registered[b].key ? registered[a].key < registered[b].key : a < b;
+    });
+    dueScratch.erase(std::unique(dueScratch.begin(), dueScratch.end()), dueScratch.end());
+    
+    // Listeners may subscribe or unregister while being called
+    for (int id : dueScratch) {
+        if (listeners[id].listener) {
+            listeners[id].listener->handleSlot(currentSlot);
+            totalCalls++;
+        }
+    }
+}
+
+void SlotClock::scheduleTick(int64_t slot)
+{
+    simtime_t time = std::max(slotStart(slot), simTime());
+    if (tickTimer->isScheduled()) {
+        if (tickTimer->getArrivalTime() <= time) {
+            return;
+        }
+        cancelEvent(tickTimer);
+    }
+    scheduleAt(time, tickTimer);
+}
+
+int SlotClock::registerListener(ISlotListener* listener, int key)
+{
+    Enter_Method_Silent();
+    
+    if (!listener) {
+        throw cRuntimeError("Cannot register a null slot listener");
+    }
+    listeners.push_back(Listener{listener, key});
+    return static_cast<int>(listeners.size()) - 1;
+}
+
+void SlotClock::unregisterListener(int listenerId)
+{
+    Enter_Method_Silent();
+    
+    // Pending subscriptions go stale and are skipped when their slot comes
+    if (listenerId >= 0 && listenerId < static_cast<int>(listeners.size())) {
+        listeners[listenerId].listener = nullptr;
+    }
+}
+
+void SlotClock::subscribe(int listenerId, int64_t slot)
+{
+    Enter_Method_Silent();
+    
+    if (listenerId < 0 || listenerId >= static_cast<int>(listeners.size()) || !listeners[listenerId].listener) {
+        throw cRuntimeError("Unknown slot listener %d", listenerId);
+    }
+    
+    slot = std::max(slot, currentSlot + 1);
+    subscriptions.schedule(slot, listenerId);
+    scheduleTick(slot);
+}
+
+int64_t SlotClock::slotAt(simtime_t time) const
+{
+    // Small tolerance so that exact slot boundaries do not round down
+    return static_cast<int64_t>(std::floor(time / slotDuration + 1e-9));
+}
+
+simtime_t SlotClock::slotStart(int64_t slot) const
+{
+    return slotDuration * static_cast<double>(slot);
+}
+
+}  // namespace nr
\ No newline at end of file
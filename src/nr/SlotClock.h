@@ -0,0 +1,89 @@
+#ifndef __SLOT_CLOCK_H
+#define __SLOT_CLOCK_H
+
+#include <omnetpp.h>
+#include <cstdint>
+#include <vector>
+
+#include "TimingWheel.h"
+
+using namespace omnetpp;
+
+namespace nr {
+
+/**
+ * @brief Interface of modules driven by the SlotClock
+ */
+class ISlotListener
+{
+  public:
+    virtual ~ISlotListener() {}
+    
+    /// Called once for every slot the listener subscribed to
+    virtual void handleSlot(int64_t slot) = 0;
+};
+
+/**
+ * @brief Network-wide slot clock driving all NRModules from one event
+ *
+ * Listeners register once and then subscribe to the slots they need to be
+ * woken up in. The clock keeps a single self-message armed for the earliest
+ * subscribed slot; when it fires, all listeners subscribed to that slot are
+ * called directly, ordered by the key they registered with (then by
+ * registration order), so runs are reproducible. A listener subscribed
+ * several times for the same slot is called once.
+ */
+class SlotClock : public cSimpleModule
+{
+  protected:
+    // Configuration parameters
+    simtime_t slotDuration;
+    
+    // Registered listeners; the index is the listener id
+    struct Listener {
+        ISlotListener* listener;   ///< Null once unregistered
+        int key;                   ///< Call order within a slot
+    };
+    std::vector<Listener> listeners;
+    
+    TimingWheel subscriptions;     ///< Listener ids keyed by slot
+    std::vector<int> dueScratch;   ///< Reused output buffer for the wheel
+    int64_t currentSlot;           ///< Last slot processed, -1 before the first
+    
+    // Self message for the next subscribed slot
+    cMessage *tickTimer;
+    
+    // Statistics
+    long totalTicks;
+    long totalCalls;
+    
+  protected:
+    // OMNeT++ module interface
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+    
+    // Internal utility functions
+    void processSlot();
+    void scheduleTick(int64_t slot);
+    
+  public:
+    SlotClock();
+    virtual ~SlotClock();
+    
+    // Listener registration
+    int registerListener(ISlotListener* listener, int key);
+    void unregisterListener(int listenerId);
+    
+    // Wake-up requests; slots already processed are moved to the next one
+    void subscribe(int listenerId, int64_t slot);
+    
+    // Slot arithmetic
+    simtime_t getSlotDuration() const { return slotDuration; }
+    int64_t slotAt(simtime_t time) const;
+    simtime_t slotStart(int64_t slot) const;
+};
+
+}  // namespace nr
+
+#endif // __SLOT_CLOCK_H
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "SlotStatistics.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace nr {
+
+SlotStatistics::SlotStatistics() :
+    listener(nullptr),
+    windowSlots(0),
+    windowIndex(0),
+    lastSlot(-1),
+    idleSlots(0)
+{
+}
+
+void SlotStatistics::configure(int64_t slots, Listener* windowListener)
+{
+    if (slots < 0) {
+        throw std::invalid_argument("SlotStatistics: window length must not be negative");
+    }
+    windowSlots = slots;
+    listener = windowListener;
+}
+
+int SlotStatistics::addSignal(double histogramMin, double histogramMax, int numBuckets, double idleValue)
+{
+    signals.push_back(Signal());
+    Signal& signal = signals.back();
+    signal.window.configure(histogramMin, histogramMax, numBuckets);
+    signal.total.configure(histogramMin, histogramMax, numBuckets);
+    signal.idleValue = idleValue;
+    return static_cast<int>(signals.size()) - 1;
+}
+
+void SlotStatistics::start(int64_t slot)
+{
+    // The start slot itself has no sample
+    lastSlot = slot;
+    windowIndex = windowSlots > 0 ? slot / windowSlots : 0;
+}
+
+long SlotStatistics::catchUp(int64_t endSlot)
+{
+    if (lastSlot < 0 || endSlot <= lastSlot + 1) {
+        return 0;
+    }
+
+    // Slots in [lastSlot + 1, endSlot) had no tick; each window gets its share
+    int64_t first = lastSlot + 1;
+    long count = static_cast<long>(endSlot - first);
+    if (windowSlots > 0) {
+        for (int64_t slot = first; slot < endSlot; ) {
+            enterWindow(slot);
+            int64_t last = std::min(endSlot, (windowIndex + 1) * windowSlots);
+            for (Signal& signal : signals) {
+                signal.window.add(signal.idleValue, static_cast<long>(last - slot));
+            }
+            slot = last;
+        }
+    }
+    lastSlot = endSlot - 1;
+    idleSlots += count;
+    return count;
+}
+
+void SlotStatistics::record(int64_t slot, int signal, double value)
+{
+    if (windowSlots > 0) {
+        enterWindow(slot);
+        signals[signal].window.add(value);
+    }
+    lastSlot = std::max(lastSlot, slot);
+}
+
+void SlotStatistics::flush()
+{
+    if (windowSlots > 0) {
+        closeWindow();
+    }
+}
+
+void SlotStatistics::enterWindow(int64_t slot)
+{
+    // Windows without samples cannot occur once every slot is accounted for
+    int64_t index = slot / windowSlots;
+    if (index > windowIndex) {
+        closeWindow();
+        windowIndex = index;
+    }
+}
+
+void SlotStatistics::closeWindow()
+{
+    bool empty = true;
+    for (const Signal& signal : signals) {
+        empty = empty && signal.window.empty();
+    }
+    if (empty) {
+        return;
+    }
+    if (listener) {
+        listener->windowClosed(*this);
+    }
+    for (Signal& signal : signals) {
+        signal.total.merge(signal.window);
+        signal.window.reset();
+    }
+}
+
+}  // namespace nr
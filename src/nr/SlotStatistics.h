@@ -0,0 +1,75 @@
+#ifndef __SLOT_STATISTICS_H
+#define __SLOT_STATISTICS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "SignalAggregator.h"
+
+namespace nr {
+
+/**
+ * @brief Per-slot signals summarised per statistics window
+ *
+ * Every slot contributes one sample per signal. Ticked slots record their
+ * samples; slots without a tick repeat the idle value of each signal and
+ * are added in bulk when the owner catches up, split at every window
+ * boundary, so the windows come out as if every slot had been ticked.
+ * Windows are aligned to multiples of windowSlots and handed to the
+ * listener as they close, one by one.
+ */
+class SlotStatistics
+{
+  public:
+    /**
+     * @brief Receives every closed window
+     */
+    class Listener
+    {
+      public:
+        virtual ~Listener() {}
+        virtual void windowClosed(const SlotStatistics& statistics) = 0;
+    };
+
+    SlotStatistics();
+
+    // Configuration; without windows only slots are counted
+    void configure(int64_t windowSlots, Listener* listener);
+    int addSignal(double histogramMin, double histogramMax, int numBuckets, double idleValue);
+    void start(int64_t slot);
+
+    // Samples
+    long catchUp(int64_t endSlot);
+    void record(int64_t slot, int signal, double value);
+    void setIdleValue(int signal, double value) { signals[signal].idleValue = value; }
+    void flush();
+
+    // Queries
+    int64_t getLastSlot() const { return lastSlot; }
+    long getIdleSlots() const { return idleSlots; }
+    double getIdleValue(int signal) const { return signals[signal].idleValue; }
+    int64_t getWindowIndex() const { return windowIndex; }
+    const SignalAggregator& getWindow(int signal) const { return signals[signal].window; }
+    const SignalAggregator& getTotal(int signal) const { return signals[signal].total; }
+
+  private:
+    struct Signal {
+        SignalAggregator window;    ///< Samples of the open window
+        SignalAggregator total;     ///< Samples of all closed windows
+        double idleValue;           ///< Sample of a slot without a tick
+    };
+
+    void enterWindow(int64_t slot);
+    void closeWindow();
+
+    std::vector<Signal> signals;
+    Listener* listener;
+    int64_t windowSlots;            ///< Window length in slots, 0 without windows
+    int64_t windowIndex;            ///< Index of the open window
+    int64_t lastSlot;               ///< Last slot with samples, -1 before start()
+    long idleSlots;                 ///< Slots added in bulk
+};
+
+}  // namespace nr
+
+#endif // __SLOT_STATISTICS_H
@@ -0,0 +1,198 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace nr {
+
+SpatialGrid::SpatialGrid() :
+    cellSize(1),
+    cellsX(1),
+    cellsY(1),
+    cells(1),
+    numPoints(0)
+{
+}
+
+void SpatialGrid::configure(double sizeX, double sizeY, double newCellSize)
+{
+    if (newCellSize <= 0 || sizeX < 0 || sizeY < 0) {
+        throw std::invalid_argument("Invalid spatial grid dimensions");
+    }
+    cellSize = newCellSize;
+    cellsX = std::max(1, static_cast<int>(std::ceil(sizeX / cellSize)));
+    cellsY = std::max(1, static_cast<int>(std::ceil(sizeY / cellSize)));
+    cells.assign(static_cast<size_t>(cellsX) * cellsY, std::vector<Point>());
+    locations.clear();
+    numPoints = 0;
+}
+
+void SpatialGrid::clear()
+{
+    for (std::vector<Point>& cell : cells) {
+        cell.clear();
+    }
+    locations.clear();
+    numPoints = 0;
+}
+
+int SpatialGrid::cellColumn(double x) const
+{
+    int column = static_cast<int>(std::floor(x / cellSize));
+    return std::min(std::max(column, 0), cellsX - 1);
+}
+
+int SpatialGrid::cellRow(double y) const
+{
+    int row = static_cast<int>(std::floor(y / cellSize));
+    return std::min(std::max(row, 0), cellsY - 1);
+}
+
+bool SpatialGrid::update(int key, double x, double y)
+{
+    if (key < 0) {
+        throw std::invalid_argument("Spatial grid keys must not be negative");
+    }
+    if (key >= static_cast<int>(locations.size())) {
+        locations.resize(key + 1, Location{-1, -1});
+    }
+    
+    int cell = cellRow(y) * cellsX + cellColumn(x);
+    Location& location = locations[key];
+    if (location.cell == cell) {
+        Point& point = cells[cell][location.slot];
+        point.x = x;
+        point.y = y;
+        return false;
+    }
+    
+    if (location.cell >= 0) {
+        unlink(location);
+    }
+    else {
+        numPoints++;
+    }
+    location.cell = cell;
+    location.slot = static_cast<int>(cells[cell].size());
+    cells[cell].push_back(Point{key, x, y});
+    return true;
+}
+
+void SpatialGrid::remove(int key)
+{
+    if (!contains(key)) {
+        return;
+    }
+    unlink(locations[key]);
+    locations[key] = Location{-1, -1};
+    numPoints--;
+}
+
+bool SpatialGrid::contains(int key) const
+{
+    return key >= 0 && key < static_cast<int>(locations.size()) && locations[key].cell >= 0;
+}
+
+void SpatialGrid::unlink(const Location& location)
+{
+    // Swap-remove, then fix the location of the point that moved into the gap
+    std::vector<Point>& cell = cells[location.cell];
+    cell[location.slot] = cell.back();
+    cell.pop_back();
+    if (location.slot < static_cast<int>(cell.size())) {
+        locations[cell[location.slot].key].slot = location.slot;
+    }
+}
+
+void SpatialGrid::queryRadius(double x, double y, double radius, std::vector<int>& out) const
+{
+    out.clear();
+    if (radius < 0 || numPoints == 0) {
+        return;
+    }
+    
+    int firstColumn = cellColumn(x - radius);
+    int lastColumn = cellColumn(x + radius);
+    int firstRow = cellRow(y - radius);
+    int lastRow = cellRow(y + radius);
+    double radiusSquared = radius * radius;
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int column = firstColumn; column <= lastColumn; column++) {
+            for (const Point& point : cells[row * cellsX + column]) {
+                double dx = point.x - x;
+                double dy = point.y - y;
+                if (dx * dx + dy * dy <= radiusSquared) {
+                    out.push_back(point.key);
+                }
+            }
+        }
+    }
+}
+
+void SpatialGrid::queryNearest(double x, double y, size_t k, std::vector<int>& out) const
+{
+    out.clear();
+    if (k == 0 || numPoints == 0) {
+        return;
+    }
+    k = std::min(k, numPoints);
+    
+    // Max-heap of the k closest points so far, keyed by squared distance
+    std::vector<std::pair<double, int>>& heap = heapScratch;
+    heap.clear();
+    int centerColumn = cellColumn(x);
+    int centerRow = cellRow(y);
+    int maxRing = std::max(cellsX, cellsY);
+    for (int ring = 0; ring <= maxRing; ring++) {
+        for (int row = centerRow - ring; row <= centerRow + ring; row++) {
+            if (row < 0 || row >= cellsY) {
+                continue;
+            }
+            // Inner rows of the ring only have their two end cells
+            bool edgeRow = row == centerRow - ring || row == centerRow + ring;
+            int step = edgeRow || ring == 0 ? 1 : 2 * ring;
+            for (int column = centerColumn - ring; column <= centerColumn + ring; column += step) {
+                if (column < 0 || column >= cellsX) {
+                    continue;
+                }
+                for (const Point& point : cells[row * cellsX + column]) {
+                    double dx = point.x - x;
+                    double dy = point.y - y;
+                    double distanceSquared = dx * dx + dy * dy;
+                    if (heap.size() < k) {
+                        heap.emplace_back(distanceSquared, point.key);
+                        std::push_heap(heap.begin(), heap.end());
+                    }
+                    else if (distanceSquared < heap.front().first) {
+                        std::pop_heap(heap.begin(), heap.end());
+                        heap.back() = std::make_pair(distanceSquared, point.key);
+                        std::push_heap(heap.begin(), heap.end());
+                    }
+                }
+            }
+        }
+        
+        // Points in later rings are at least ring cell sizes away
+        double bound = ring * cellSize;
+        if (heap.size() == k && heap.front().first <= bound * bound) {
+            break;
+        }
+    }
+    
+    std::sort_heap(heap.begin(), heap.end());
+    for (const auto& entry : heap) {
+        out.push_back(entry.second);
+    }
+}
+
+size_t SpatialGrid::getMemoryFootprint() const
+{
+    size_t bytes = sizeof(*this) + cells.capacity() * sizeof(std::vector<Point>) +
+                   locations.capacity() * sizeof(Location);
+    for (const std::vector<Point>& cell : cells) {
+        bytes += cell.capacity() * sizeof(Point);
+    }
+    return bytes;
+}
+
+}  // namespace nr
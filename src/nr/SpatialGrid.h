@@ -0,0 +1,72 @@
+#ifndef __SPATIAL_GRID_H
+#define __SPATIAL_GRID_H
+
+#include <cstddef>
+#include <vector>
+
+namespace nr {
+
+/**
+ * @brief Uniform grid of points for radius and k-nearest queries
+ *
+ * The area [0, sizeX] x [0, sizeY] is cut into square cells, and every
+ * point lives in the list of the cell it is in; points outside the area
+ * are kept in the nearest border cell. Moving a point within its cell
+ * only overwrites its coordinates, and moving it to another cell is a
+ * swap-remove and an append, so updates are O(1). A radius query visits
+ * the cells overlapping the circle, and a k-nearest query grows rings of
+ * cells around the query point until no closer point can remain, so both
+ * cost O(points nearby) as long as the cell size is in the order of the
+ * query radius.
+ *
+ * Keys are small non-negative integers, such as module ids.
+ */
+class SpatialGrid
+{
+  public:
+    SpatialGrid();
+
+    // Sizing, removes all points
+    void configure(double sizeX, double sizeY, double cellSize);
+    void clear();
+
+    // Incremental updates; returns true when the point changed cell
+    bool update(int key, double x, double y);
+    void remove(int key);
+    bool contains(int key) const;
+    size_t size() const { return numPoints; }
+
+    // Queries; the output is overwritten, nearest neighbours come closest first
+    void queryRadius(double x, double y, double radius, std::vector<int>& out) const;
+    void queryNearest(double x, double y, size_t k, std::vector<int>& out) const;
+
+    double getCellSize() const { return cellSize; }
+    size_t getMemoryFootprint() const;
+
+  private:
+    struct Point {
+        int key;
+        double x;
+        double y;
+    };
+    struct Location {
+        int cell;      ///< -1 while the key is not in the grid
+        int slot;      ///< Position in the cell's point list
+    };
+
+    double cellSize;
+    int cellsX;
+    int cellsY;
+    std::vector<std::vector<Point>> cells;
+    std::vector<Location> locations;   ///< Indexed by key
+    size_t numPoints;
+    mutable std::vector<std::pair<double, int>> heapScratch;
+
+    int cellColumn(double x) const;
+    int cellRow(double y) const;
+    void unlink(const Location& location);
+};
+
+}  // namespace nr
+
+#endif // __SPATIAL_GRID_H
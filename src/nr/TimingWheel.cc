@@ -0,0 +1,124 @@
+#include "TimingWheel.h"
+#include <stdexcept>
+
+namespace nr {
+
+TimingWheel::TimingWheel(int minBuckets) :
+    cursor(0),
+    mask(0),
+    numPending(0),
+    nextSlot(-1)
+{
+    resize(minBuckets);
+}
+
+void TimingWheel::resize(int minBuckets)
+{
+    if (minBuckets <= 0) {
+        throw std::invalid_argument("TimingWheel: bucket count must be positive");
+    }
+
+    size_t count = 1;
+    while (count < static_cast<size_t>(minBuckets)) {
+        count <<= 1;
+    }
+    if (count == buckets.size()) {
+        return;
+    }
+
+    // Rehash pending entries into the new ring
+    std::vector<std::vector<Entry>> old;
+    old.swap(buckets);
+    buckets.resize(count);
+    mask = count - 1;
+    for (const auto& bucket : old) {
+        for (const Entry& entry : bucket) {
+            buckets[entry.slot & mask].push_back(entry);
+        }
+    }
+}
+
+void TimingWheel::clear()
+{
+    for (auto& bucket : buckets) {
+        bucket.clear();
+    }
+    numPending = 0;
+    nextSlot = -1;
+}
+
+void TimingWheel::schedule(int64_t slot, int id)
+{
+    // Anything already due goes into the next bucket to be drained
+    if (slot < cursor) {
+        slot = cursor;
+    }
+    buckets[slot & mask].push_back(Entry{slot, id});
+    numPending++;
+    if (nextSlot < 0 || slot < nextSlot) {
+        nextSlot = slot;
+    }
+}
+
+void TimingWheel::advance(int64_t currentSlot, std::vector<int>& expired)
+{
+    if (currentSlot < cursor) {
+        return;
+    }
+
+    // Visit each elapsed slot's bucket once, never more than a full turn
+    int64_t turnEnd = cursor + static_cast<int64_t>(buckets.size()) - 1;
+    int64_t last = currentSlot < turnEnd ? currentSlot : turnEnd;
+    for (int64_t slot = cursor; slot <= last; slot++) {
+        std::vector<Entry>& bucket = buckets[slot & mask];
+        for (size_t i = 0; i < bucket.size(); ) {
+            if (bucket[i].slot <= currentSlot) {
+                expired.push_back(bucket[i].id);
+                bucket[i] = bucket.back();
+                bucket.pop_back();
+                numPending--;
+            }
+            else {
+                i++;
+            }
+        }
+    }
+    cursor = currentSlot + 1;
+
+    // Only draining the earliest entry moves the minimum
+    if (nextSlot >= 0 && nextSlot <= currentSlot) {
+        nextSlot = findNextExpirySlot();
+    }
+}
+
+int64_t TimingWheel::findNextExpirySlot() const
+{
+    if (numPending == 0) {
+        return -1;
+    }
+
+    // Scan one turn from the cursor; the first hit within the turn wins
+    int64_t earliest = -1;
+    for (int64_t slot = cursor; slot < cursor + static_cast<int64_t>(buckets.size()); slot++) {
+        for (const Entry& entry : buckets[slot & mask]) {
+            if (entry.slot == slot) {
+                return slot;
+            }
+            if (earliest < 0 || entry.slot < earliest) {
+                earliest = entry.slot;
+            }
+        }
+    }
+    return earliest;
+}
+
+size_t TimingWheel::getMemoryFootprint() const
+{
+    size_t bytes = buckets.capacity() * sizeof(std::vector<Entry>);
+    for (const auto& bucket : buckets) {
+        bytes += bucket.capacity() * sizeof(Entry);
+    }
+    return bytes;
+}
+
+}  // namespace nr
\ No newline at end of file
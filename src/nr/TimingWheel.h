@@ -0,0 +1,54 @@
+#ifndef __TIMING_WHEEL_H
+#define __TIMING_WHEEL_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace nr {
+
+/**
+ * @brief Slot-indexed timing wheel for allocation expiry
+ *
+ * Entries are hashed into a power-of-two ring of buckets by their expiry
+ * slot. Advancing the wheel visits only the buckets of the elapsed slots
+ * (at most one full turn), so the cost scales with the number of
+ * expirations rather than with the number of pending entries. Each entry
+ * keeps its absolute slot, which makes entries more than one turn ahead
+ * safe: they simply stay in their bucket until their slot comes around.
+ */
+class TimingWheel
+{
+  public:
+    explicit TimingWheel(int minBuckets = 64);
+
+    // Sizing
+    void resize(int minBuckets);
+    void clear();
+    int bucketCount() const { return static_cast<int>(buckets.size()); }
+    size_t pending() const { return numPending; }
+    size_t getMemoryFootprint() const;
+
+    // Scheduling
+    void schedule(int64_t slot, int id);
+    void advance(int64_t currentSlot, std::vector<int>& expired);
+    int64_t nextExpirySlot() const { return nextSlot; }
+
+  private:
+    struct Entry {
+        int64_t slot;   ///< Absolute expiry slot
+        int id;         ///< Caller-defined identifier
+    };
+
+    int64_t findNextExpirySlot() const;
+
+    std::vector<std::vector<Entry>> buckets;
+    int64_t cursor;        ///< Next slot that has not been drained yet
+    size_t mask;
+    size_t numPending;
+    int64_t nextSlot;      ///< Earliest pending expiry slot, -1 when empty
+};
+
+}  // namespace nr
+
+#endif // __TIMING_WHEEL_H
\ No newline at end of file
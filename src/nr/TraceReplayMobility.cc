@@ -0,0 +1,102 @@
+#include "TraceReplayMobility.h"
+#include <inet/common/ModuleAccess.h>
+#include <algorithm>
+#include <cmath>
+
+namespace nr {
+
+Define_Module(TraceReplayMobility);
+
+TraceReplayMobility::TraceReplayMobility() :
+    stepLength(0),
+    z(0),
+    vehicle(nullptr),
+    samples(nullptr),
+    appliedStep(-1),
+    stepStart(0)
+{
+}
+
+void TraceReplayMobility::initialize(int stage)
+{
+    MovingMobilityBase::initialize(stage);
+    
+    if (stage == inet::INITSTAGE_LOCAL) {
+        std::string traceFile = par("traceFile").stringValue();
+        trace = MobilityTraceReader::openShared(traceFile);
+        if (!trace) {
+            throw cRuntimeError("Could not open mobility trace %s", traceFile.c_str());
+        }
+        
+        // By default vehicle[i] replays the vehicle recorded with index i
+        int index = par("traceVehicle");
+        if (index < 0) {
+            cModule* node = inet::findContainingNode(this);
+            index = node ? node->getIndex() : 0;
+        }
+        vehicle = trace->findVehicle(index);
+        if (!vehicle || vehicle->numSteps <= 0) {
+            throw cRuntimeError("Vehicle %d is not in mobility trace %s", index, traceFile.c_str());
+        }
+        samples = trace->getSamples(*vehicle);
+        stepLength = trace->getStepLength();
+        z = par("z").doubleValue();
+        
+        // Updates follow the trace steps only
+        updateInterval = 0;
+    }
+}
+
+void TraceReplayMobility::setInitialPosition()
+{
+    move();
+}
+
+void TraceReplayMobility::move()
+{
+    int64_t step = currentStep();
+    if (step != appliedStep) {
+        applyStep(step);
+    }
+    
+    // Within a step the vehicle moves on with the sampled velocity; parked ones have none
+    lastPosition = stepPosition + lastVelocity * (SIMTIME_DBL(simTime()) - stepStart);
+}
+
+int64_t TraceReplayMobility::currentStep() const
+{
+    return static_cast<int64_t>(std::floor(SIMTIME_DBL(simTime()) / stepLength + 1e-9));
+}
+
+void TraceReplayMobility::applyStep(int64_t step)
+{
+    int64_t offset = step - vehicle->firstStep;
+    int64_t clamped = std::min<int64_t>(std::max<int64_t>(offset, 0), vehicle->numSteps - 1);
+    const MobilityTraceSample& sample = samples[clamped];
+    appliedStep = step;
+    stepPosition = inet::Coord(sample.x, sample.y, z);
+    stepStart = stepLength * step;
+    
+    // Parked vehicles stand still and wake up for their first step only
+    if (offset < 0) {
+        lastVelocity = inet::Coord::ZERO;
+        nextChange = stepLength * vehicle->firstStep;
+    }
+    else if (offset < vehicle->numSteps) {
+        lastVelocity = inet::Coord(sample.speed * std::cos(sample.heading), sample.speed * std::sin(sample.heading), 0);
+        nextChange = stepLength * (step + 1);
+    }
+    else {
+        lastVelocity = inet::Coord::ZERO;
+        nextChange = -1;
+        stationary = true;
+    }
+}
+
+bool TraceReplayMobility::isInTrace() const
+{
+    int64_t offset = currentStep() - vehicle->firstStep;
+    return offset >= 0 && offset < vehicle->numSteps;
+}
+
+}  // namespace nr
@@ -0,0 +1,63 @@
+#ifndef __TRACE_REPLAY_MOBILITY_H
+#define __TRACE_REPLAY_MOBILITY_H
+
+#include <omnetpp.h>
+#include <inet/common/INETDefs.h>
+#include <inet/mobility/base/MovingMobilityBase.h>
+#include <memory>
+
+#include "MobilityTrace.h"
+
+using namespace omnetpp;
+
+namespace nr {
+
+/**
+ * @brief Mobility model replaying one vehicle of a recorded mobility trace
+ *
+ * Reads the vehicle's samples straight from the memory-mapped trace
+ * written by MobilityTraceRecorder, so runs need neither SUMO nor TraCI.
+ * The trace is mapped once per process and shared by all vehicles. Each
+ * trace step starts at its sampled position, and within the step the
+ * vehicle moves on with the sampled velocity, so the reported position
+ * and velocity agree. Before its first step and after its last one the
+ * vehicle is parked at its first or last sampled position.
+ */
+class TraceReplayMobility : public inet::MovingMobilityBase
+{
+  protected:
+    // Configuration parameters
+    double stepLength;           ///< Step of the trace in s
+    double z;                    ///< Height, not part of the trace
+    
+    // Trace of this vehicle
+    std::shared_ptr<const MobilityTraceReader> trace;
+    const MobilityTraceVehicle* vehicle;
+    const MobilityTraceSample* samples;
+    
+    // Step being replayed
+    int64_t appliedStep;         ///< -1 before the first
+    inet::Coord stepPosition;    ///< Sampled position at the start of the step
+    double stepStart;            ///< Start of the step in s
+    
+  protected:
+    // INET mobility interface
+    virtual int numInitStages() const override { return inet::NUM_INIT_STAGES; }
+    virtual void initialize(int stage) override;
+    virtual void setInitialPosition() override;
+    virtual void move() override;
+    
+    // Internal utility functions
+    int64_t currentStep() const;
+    void applyStep(int64_t step);
+    
+  public:
+    TraceReplayMobility();
+    
+    // Lifetime of the vehicle in the trace
+    bool isInTrace() const;
+};
+
+}  // namespace nr
+
+#endif // __TRACE_REPLAY_MOBILITY_H
@@ -0,0 +1,118 @@
+#include "TraceRing.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace nr {
+
+TraceRing::TraceRing() :
+    mask(0),
+    head(0)
+{
+}
+
+void TraceRing::open(size_t minCapacity)
+{
+    size_t count = 1;
+    while (count < minCapacity) {
+        count <<= 1;
+    }
+    records.assign(count, TraceRecord());
+    mask = count - 1;
+    head.store(0, std::memory_order_relaxed);
+}
+
+void TraceRing::close()
+{
+    records.clear();
+    records.shrink_to_fit();
+    mask = 0;
+    head.store(0, std::memory_order_relaxed);
+}
+
+void TraceRing::append(int64_t slot, int ue, TraceEvent event, int aux, int firstBlock, int blockCount)
+{
+    // Writers only contend on the counter; a lapped slot is simply overwritten
+    uint64_t position = head.fetch_add(1, std::memory_order_relaxed);
+    TraceRecord& record = records[position & mask];
+    record.slot = slot;
+    record.ue = ue;
+    record.event = static_cast<uint16_t>(event);
+    record.aux = static_cast<uint16_t>(aux);
+    record.firstBlock = firstBlock;
+    record.blockCount = blockCount;
+}
+
+bool TraceRing::dump(const std::string& path) const
+{
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    uint64_t total = totalAppended();
+    uint64_t stored = total < records.size() ? total : records.size();
+
+    TraceFileHeader header;
+    std::memcpy(header.magic, "NRTR", 4);
+    header.version = FILE_VERSION;
+    header.recordSize = sizeof(TraceRecord);
+    header.reserved = 0;
+    header.totalRecords = total;
+    header.storedRecords = stored;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+
+    // Oldest first: the ring may have wrapped, so write it in up to two pieces
+    uint64_t start = total - stored;
+    for (uint64_t written = 0; ok && written < stored; ) {
+        size_t offset = static_cast<size_t>((start + written) & mask);
+        size_t chunk = static_cast<size_t>(std::min<uint64_t>(stored - written, records.size() - offset));
+        ok = std::fwrite(&records[offset], sizeof(TraceRecord), chunk, file) == chunk;
+        written += chunk;
+    }
+
+    return std::fclose(file) == 0 && ok;
+}
+
+bool TraceRing::load(const std::string& path, TraceFileHeader& header, std::vector<TraceRecord>& out)
+{
+    out.clear();
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+              std::memcmp(header.magic, "NRTR", 4) == 0 &&
+              header.version == FILE_VERSION &&
+              header.recordSize == sizeof(TraceRecord);
+    if (ok) {
+        out.resize(static_cast<size_t>(header.storedRecords));
+        ok = std::fread(out.data(), sizeof(TraceRecord), out.size(), file) == out.size();
+    }
+
+    std::fclose(file);
+    return ok;
+}
+
+const char* TraceRing::eventName(uint16_t event)
+{
+    switch (static_cast<TraceEvent>(event)) {
+        case TraceEvent::SLOT_TICK: return "tick";
+        case TraceEvent::ALLOCATE: return "allocate";
+        case TraceEvent::ALLOCATION_FAILED: return "allocation-failed";
+        case TraceEvent::RELEASE: return "release";
+        case TraceEvent::EXPIRE: return "expire";
+        case TraceEvent::PREEMPT: return "preempt";
+        case TraceEvent::MODE_SWITCH: return "mode-switch";
+    }
+    return "unknown";
+}
+
+TraceRing& TraceRing::global()
+{
+    static TraceRing ring;
+    return ring;
+}
+
+}  // namespace nr
\ No newline at end of file
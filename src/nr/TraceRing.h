@@ -0,0 +1,106 @@
+#ifndef __TRACE_RING_H
+#define __TRACE_RING_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace nr {
+
+/**
+ * @brief Event codes stored in TraceRecord::event
+ */
+enum class TraceEvent : uint16_t {
+    SLOT_TICK = 1,           ///< Allocation tick of a UE
+    ALLOCATE = 2,            ///< Blocks granted, aux = priority
+    ALLOCATION_FAILED = 3,   ///< Request refused, aux = priority, count = size
+    RELEASE = 4,             ///< Allocation released by its owner
+    EXPIRE = 5,              ///< Allocation released by the expiry wheel
+    PREEMPT = 6,             ///< Allocation evicted, aux = victim priority
+    MODE_SWITCH = 7          ///< Mode switched, aux = new mode
+};
+
+/**
+ * @brief Fixed-size binary trace record
+ */
+struct TraceRecord {
+    int64_t slot;            ///< Slot index the event happened in
+    int32_t ue;              ///< Module id of the UE
+    uint16_t event;          ///< TraceEvent code
+    uint16_t aux;            ///< Event-specific value, see TraceEvent
+    int32_t firstBlock;      ///< First block of the range, -1 if none
+    int32_t blockCount;      ///< Number of blocks in the range
+};
+
+/**
+ * @brief Header written in front of the records of a trace file
+ */
+struct TraceFileHeader {
+    char magic[4];           ///< "NRTR"
+    uint32_t version;
+    uint32_t recordSize;     ///< sizeof(TraceRecord) of the writer
+    uint32_t reserved;
+    uint64_t totalRecords;   ///< Records appended over the whole run
+    uint64_t storedRecords;  ///< Records in the file, the newest ones
+};
+
+/**
+ * @brief Lock-free ring of binary trace records for post-run analysis
+ *
+ * Appending claims a position with a single atomic increment and copies a
+ * fixed-size record, so the hot path does no formatting and takes no lock.
+ * When the ring is full the oldest records are overwritten. The ring is
+ * dumped to a file after the run and read back with the decoder in tools/.
+ *
+ * This header does not depend on OMNeT++ so that the decoder can use it.
+ * Call sites use NR_TRACE, which compiles to nothing unless the build
+ * defines NR_TRACE_ENABLED (CMake option NR_TRACE).
+ */
+class TraceRing
+{
+  public:
+    TraceRing();
+
+    // Lifetime; open and close must not race with append
+    void open(size_t minCapacity);
+    void close();
+    bool isOpen() const { return !records.empty(); }
+    size_t capacity() const { return records.size(); }
+    uint64_t totalAppended() const { return head.load(std::memory_order_relaxed); }
+
+    // Hot path
+    void append(int64_t slot, int ue, TraceEvent event, int aux, int firstBlock, int blockCount);
+
+    // Post-run file access, oldest record first
+    bool dump(const std::string& path) const;
+    static bool load(const std::string& path, TraceFileHeader& header, std::vector<TraceRecord>& out);
+    static const char* eventName(uint16_t event);
+
+    // Process-wide ring shared by all UEs
+    static TraceRing& global();
+
+  private:
+    std::vector<TraceRecord> records;
+    size_t mask;
+    std::atomic<uint64_t> head;     ///< Total records appended; next write position
+
+    static const uint32_t FILE_VERSION = 1;
+};
+
+}  // namespace nr
+
+#ifdef NR_TRACE_ENABLED
+#define NR_TRACE(slot, ue, event, aux, firstBlock, blockCount) \
+    do { \
+        nr::TraceRing& nrTraceRing_ = nr::TraceRing::global(); \
+        if (nrTraceRing_.isOpen()) { \
+            nrTraceRing_.append((slot), (ue), (event), (aux), (firstBlock), (blockCount)); \
+        } \
+    } while (0)
+#else
+#define NR_TRACE(slot, ue, event, aux, firstBlock, blockCount) do { } while (0)
+#endif
+
+#endif // __TRACE_RING_H
\ No newline at end of file
@@ -0,0 +1,77 @@
+#!/bin/sh
+# Generates the SUMO grid network and routes of one size of the Scaling config.
+# Usage: generate_scaling_scenario.sh <vehicles> [output dir]
+#
+# The grid grows with the vehicle count so that the density stays at about two
+# vehicles per 200 m block; all vehicles depart within the first 10 s on routes
+# of at least half the grid side, so they are still driving when the run ends.
+# Needs SUMO_ROOT (netgenerate and tools/randomTrips.py).
+set -e
+
+if [ $# -lt 1 ]; then
+    echo "Usage: $0 <vehicles> [output dir]" >&2
+    exit 1
+fi
+if [ -z "$SUMO_ROOT" ]; then
+    echo "$0: SUMO_ROOT is not set" >&2
+    exit 1
+fi
+
+vehicles=$1
+scenarios=$(cd "$(dirname "$0")/../simulations/scenarios" && pwd)
+output=${2:-$scenarios/scaling/$vehicles}
+block=200
+grid=$(awk -v n="$vehicles" 'BEGIN { g = int(sqrt(n / 2)); if (g * g < n / 2) g++; print g + 1 }')
+side=$(((grid - 1) * block))
+period=$(awk -v n="$vehicles" 'BEGIN { printf "%.6f", 10 / n }')
+
+mkdir -p "$output"
+"$SUMO_ROOT/bin/netgenerate" --grid --grid.number "$grid" --grid.length "$block" \
+    --default.lanenumber 2 --default.speed 13.89 --no-turnarounds \
+    --output-file "$output/scaling.net.xml"
+python3 "$SUMO_ROOT/tools/randomTrips.py" --net-file "$output/scaling.net.xml" \
+    --output-trip-file "$output/scaling.trips.xml" --route-file "$output/scaling.rou.xml" \
+    --begin 0 --end 10 --period "$period" --min-distance $((side / 2)) --seed 42 \
+    --trip-attributes 'departLane="best" departSpeed="max"'
+
+cat > "$output/scaling.sumo.cfg" <<CFG
+<?xml version="1.0" encoding="UTF-8"?>
+
+<configuration xmlns:xsi="http://www.w3.org/2001/XMLSchema-instance" xsi:noNamespaceSchemaLocation="http://sumo.dlr.de/xsd/sumoConfiguration.xsd">
+
+    <input>
+        <net-file value="scaling.net.xml"/>
+        <route-files value="scaling.rou.xml"/>
+    </input>
+
+    <time>
+        <begin value="0"/>
+        <end value="1000"/>
+        <step-length value="0.1"/>
+    </time>
+
+    <processing>
+        <collision.action value="warn"/>
+        <time-to-teleport value="-1"/>
+    </processing>
+
+    <report>
+        <no-step-log value="true"/>
+    </report>
+
+</configuration>
+CFG
+
+cat > "$output/launchd.xml" <<LAUNCH
+<?xml version="1.0"?>
+<launch>
+    <copy file="scaling.net.xml" />
+    <copy file="scaling.rou.xml" />
+    <copy file="scaling.sumo.cfg" type="config" />
+
+    <basedir path="." />
+    <seed value="23234" />
+</launch>
+LAUNCH
+
+echo "$vehicles vehicles on a ${grid}x${grid} grid (${side} m) in $output"
@@ -0,0 +1,270 @@
+// Check and benchmark for InterferenceCalculator and its vector kernels
+//
+// Usage: nr_interference_bench [--nodes N] [--transmitters N] [--slots N] [--seed N]
+//
+// Built three times, for scalar, SSE and AVX2 kernels (nr_interference_bench,
+// _scalar and _avx2). Every build first compares received power and SINR of
+// the calculator against a double-precision reference, then times gains
+// computed for every pair (reuse distance 0) and served from the cache
+// (static nodes), and reports the hit ratio of a run with slowly moving
+// nodes. Exits with 1 if the check fails, with 77 if the CPU lacks the
+// instructions the build was compiled for.
+
+#include "InterferenceCalculator.h"
+#include "InterferenceKernels.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace nr;
+
+static const double CARRIER_FREQUENCY = 5.9e9;
+static const double NOISE_MW = 1e-10;
+static const double AREA = 2000.0;    ///< Side of the square the nodes are placed in, m
+
+struct Options {
+    int nodes;
+    int transmitters;
+    int slots;
+    unsigned seed;
+};
+
+struct Scenario {
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<int> receivers;
+    std::vector<int> transmitters;
+    std::vector<float> txPowerMw;
+};
+
+static Scenario makeScenario(const Options& options, std::mt19937& random)
+{
+    Scenario scenario;
+    std::uniform_real_distribution<double> coordinate(0, AREA);
+    std::uniform_real_distribution<double> power(10, 200);
+    for (int i = 0; i < options.nodes; i++) {
+        scenario.x.push_back(coordinate(random));
+        scenario.y.push_back(coordinate(random));
+        scenario.receivers.push_back(i);
+    }
+
+    // Every node receives; a random subset transmits, some co-located to exercise the 1 m clamp
+    std::vector<int> order(scenario.receivers);
+    std::shuffle(order.begin(), order.end(), random);
+    scenario.transmitters.assign(order.begin(), order.begin() + options.transmitters);
+    for (int i = 0; i < options.transmitters; i++) {
+        scenario.txPowerMw.push_back(static_cast<float>(power(random)));
+    }
+    for (int i = 0; i + 1 < options.transmitters && i < 8; i += 2) {
+        scenario.x[scenario.transmitters[i + 1]] = scenario.x[scenario.transmitters[i]] + 0.3;
+        scenario.y[scenario.transmitters[i + 1]] = scenario.y[scenario.transmitters[i]];
+    }
+    return scenario;
+}
+
+// The kernels' formulas in double precision, one receiver at a time, from the
+// positions as the calculator stores them
+static void reference(const Scenario& scenario, int receiver, std::vector<double>& received, std::vector<double>& sinr)
+{
+    double factor = interference::freeSpaceFactor(CARRIER_FREQUENCY);
+    size_t numTx = scenario.transmitters.size();
+    received.assign(numTx, 0.0);
+    sinr.assign(numTx, 0.0);
+    double total = 0;
+    for (size_t i = 0; i < numTx; i++) {
+        int tx = scenario.transmitters[i];
+        if (tx == receiver) {
+            continue;
+        }
+        double dx = static_cast<double>(static_cast<float>(scenario.x[tx])) - static_cast<float>(scenario.x[receiver]);
+        double dy = static_cast<double>(static_cast<float>(scenario.y[tx])) - static_cast<float>(scenario.y[receiver]);
+        received[i] = scenario.txPowerMw[i] / (factor * std::max(dx * dx + dy * dy, 1.0));
+        total += received[i];
+    }
+    for (size_t i = 0; i < numTx; i++) {
+        sinr[i] = received[i] / (total - received[i] + NOISE_MW);
+    }
+}
+
+static void place(InterferenceCalculator& calculator, const Scenario& scenario)
+{
+    for (size_t i = 0; i < scenario.x.size(); i++) {
+        calculator.setPosition(static_cast<int>(i), scenario.x[i], scenario.y[i]);
+    }
+}
+
+// Largest relative error of the calculator against the reference, over all pairs
+static bool check(const Scenario& scenario, double& receivedError, double& sinrError)
+{
+    InterferenceCalculator calculator;
+    calculator.configure(CARRIER_FREQUENCY, 0, NOISE_MW);
+    place(calculator, scenario);
+
+    int numTx = static_cast<int>(scenario.transmitters.size());
+    std::vector<float> received(numTx);
+    std::vector<float> sinr(numTx);
+    std::vector<double> expectedReceived;
+    std::vector<double> expectedSinr;
+    receivedError = 0;
+    sinrError = 0;
+    for (int receiver : scenario.receivers) {
+        calculator.computeReceiver(receiver, scenario.transmitters.data(), scenario.txPowerMw.data(), numTx,
+                                   received.data(), sinr.data());
+        reference(scenario, receiver, expectedReceived, expectedSinr);
+        for (int i = 0; i < numTx; i++) {
+            if (expectedReceived[i] == 0) {
+                if (received[i] != 0) {
+                    return false;  // Own transmission
+                }
+                continue;
+            }
+            receivedError = std::max(receivedError, std::fabs(received[i] - expectedReceived[i]) / expectedReceived[i]);
+            // The float denominator loses about (1 + SINR) times the precision of the sum
+            double scale = expectedSinr[i] * (1 + expectedSinr[i]);
+            sinrError = std::max(sinrError, std::fabs(sinr[i] - expectedSinr[i]) / scale);
+        }
+    }
+
+    // A cached run at unchanged positions gives the same floats as the uncached one
+    InterferenceCalculator cached;
+    cached.configure(CARRIER_FREQUENCY, 10, NOISE_MW);
+    place(cached, scenario);
+    std::vector<float> cachedReceived(numTx);
+    std::vector<float> cachedSinr(numTx);
+    for (int pass = 0; pass < 2; pass++) {
+        for (int receiver : scenario.receivers) {
+            calculator.computeReceiver(receiver, scenario.transmitters.data(), scenario.txPowerMw.data(), numTx,
+                                       received.data(), sinr.data());
+            cached.computeReceiver(receiver, scenario.transmitters.data(), scenario.txPowerMw.data(), numTx,
+                                   cachedReceived.data(), cachedSinr.data());
+            if (received != cachedReceived || sinr != cachedSinr) {
+                return false;
+            }
+        }
+    }
+    uint64_t pairs = static_cast<uint64_t>(scenario.receivers.size()) * numTx;
+    return cached.getCacheMisses() == pairs && cached.getCacheHits() == pairs;
+}
+
+// Mean time per (receiver, transmitter) pair over a number of slots; nodes move by step m per slot
+static double timePairs(const Scenario& start, const Options& options, double reuseDistance, double step,
+                        std::mt19937& random, double* hitRatio)
+{
+    Scenario scenario = start;
+    InterferenceCalculator calculator;
+    calculator.configure(CARRIER_FREQUENCY, reuseDistance, NOISE_MW);
+    place(calculator, scenario);
+
+    int numRx = static_cast<int>(scenario.receivers.size());
+    int numTx = static_cast<int>(scenario.transmitters.size());
+    std::vector<float> received(static_cast<size_t>(numRx) * numTx);
+    std::vector<float> sinr(received.size());
+    std::uniform_real_distribution<double> heading(0, 2 * M_PI);
+
+    // The first slot fills the cache and is not timed
+    calculator.compute(scenario.receivers.data(), numRx, scenario.transmitters.data(), scenario.txPowerMw.data(),
+                       numTx, received.data(), sinr.data());
+    uint64_t hitsBefore = calculator.getCacheHits();
+    uint64_t missesBefore = calculator.getCacheMisses();
+    double elapsed = 0;
+    for (int slot = 0; slot < options.slots; slot++) {
+        if (step > 0) {
+            for (size_t i = 0; i < scenario.x.size(); i++) {
+                double angle = heading(random);
+                scenario.x[i] += step * std::cos(angle);
+                scenario.y[i] += step * std::sin(angle);
+            }
+        }
+        auto begin = std::chrono::steady_clock::now();
+        if (step > 0) {
+            place(calculator, scenario);
+        }
+        calculator.compute(scenario.receivers.data(), numRx, scenario.transmitters.data(),
+                           scenario.txPowerMw.data(), numTx, received.data(), sinr.data());
+        elapsed += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    }
+    if (hitRatio) {
+        double hits = static_cast<double>(calculator.getCacheHits() - hitsBefore);
+        double misses = static_cast<double>(calculator.getCacheMisses() - missesBefore);
+        *hitRatio = hits + misses > 0 ? hits / (hits + misses) : 0.0;
+    }
+    return elapsed * 1e9 / (static_cast<double>(options.slots) * numRx * numTx);
+}
+
+static void usage(const char* program)
+{
+    std::fprintf(stderr, "Usage: %s [--nodes N] [--transmitters N] [--slots N] [--seed N]\n", program);
+}
+
+int main(int argc, char** argv)
+{
+    Options options{500, 100, 50, 1};
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        const char* name = argv[i];
+        const char* value = argv[++i];
+        if (std::strcmp(name, "--nodes") == 0) {
+            options.nodes = std::atoi(value);
+        }
+        else if (std::strcmp(name, "--transmitters") == 0) {
+            options.transmitters = std::atoi(value);
+        }
+        else if (std::strcmp(name, "--slots") == 0) {
+            options.slots = std::atoi(value);
+        }
+        else if (std::strcmp(name, "--seed") == 0) {
+            options.seed = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        }
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (options.nodes <= 0 || options.transmitters <= 0 || options.transmitters > options.nodes || options.slots <= 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::string instructionSet = interference::instructionSet();
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    if (instructionSet == "avx2" && !__builtin_cpu_supports("avx2")) {
+        std::fprintf(stderr, "%s: the CPU does not support AVX2\n", argv[0]);
+        return 77;
+    }
+#endif
+
+    std::mt19937 random(options.seed);
+    Scenario scenario = makeScenario(options, random);
+
+    // float arithmetic against double, a few ulp per pair plus the float sum for the SINR
+    double receivedError;
+    double sinrError;
+    bool same = check(scenario, receivedError, sinrError) && receivedError < 1e-5 && sinrError < 1e-4;
+
+    double uncached = timePairs(scenario, options, 0, 0, random, nullptr);
+    double cached = timePairs(scenario, options, 1e9, 0, random, nullptr);
+    double movingHitRatio;
+    double moving = timePairs(scenario, options, 5, 1, random, &movingHitRatio);
+
+    std::printf("statistic,value\n");
+    std::printf("instructionSet,%s\n", instructionSet.c_str());
+    std::printf("nodes,%d\n", options.nodes);
+    std::printf("transmitters,%d\n", options.transmitters);
+    std::printf("maxReceivedError,%g\n", receivedError);
+    std::printf("maxSinrError,%g\n", sinrError);
+    std::printf("uncachedNsPerPair,%g\n", uncached);
+    std::printf("cachedNsPerPair,%g\n", cached);
+    std::printf("movingNsPerPair,%g\n", moving);
+    std::printf("movingHitRatio,%g\n", movingHitRatio);
+    std::printf("result,%s\n", same ? "same" : "different");
+    return same ? 0 : 1;
+}
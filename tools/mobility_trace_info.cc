@@ -0,0 +1,69 @@
+// Prints a mobility trace written by nr::MobilityTraceWriter as CSV or a per-vehicle summary
+//
+// Usage: nr_mobility_trace [--summary] <trace file>
+
+#include "MobilityTrace.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace nr;
+
+static void printCsv(const MobilityTraceReader& trace)
+{
+    std::printf("time,vehicle,x,y,speed,heading\n");
+    double step = trace.getStepLength();
+    for (uint32_t i = 0; i < trace.getNumVehicles(); i++) {
+        const MobilityTraceVehicle& vehicle = trace.getVehicle(i);
+        const MobilityTraceSample* samples = trace.getSamples(vehicle);
+        for (int32_t s = 0; s < vehicle.numSteps; s++) {
+            std::printf("%g,%d,%g,%g,%g,%g\n", (vehicle.firstStep + s) * step, vehicle.index,
+                        samples[s].x, samples[s].y, samples[s].speed, samples[s].heading);
+        }
+    }
+}
+
+static void printSummary(const MobilityTraceReader& trace)
+{
+    double step = trace.getStepLength();
+    std::printf("step length:      %g s\n", step);
+    std::printf("vehicles:         %u\n", trace.getNumVehicles());
+    std::printf("samples:          %llu\n", static_cast<unsigned long long>(trace.getNumSamples()));
+    std::printf("vehicle,appears,leaves\n");
+    for (uint32_t i = 0; i < trace.getNumVehicles(); i++) {
+        const MobilityTraceVehicle& vehicle = trace.getVehicle(i);
+        std::printf("%d,%g,%g\n", vehicle.index, vehicle.firstStep * step,
+                    (vehicle.firstStep + vehicle.numSteps) * step);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool summary = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--summary") == 0) {
+            summary = true;
+        }
+        else {
+            path = argv[i];
+        }
+    }
+    if (!path) {
+        std::fprintf(stderr, "Usage: %s [--summary] <trace file>\n", argv[0]);
+        return 2;
+    }
+
+    MobilityTraceReader trace;
+    if (!trace.open(path)) {
+        std::fprintf(stderr, "%s: not a readable mobility trace\n", path);
+        return 1;
+    }
+
+    if (summary) {
+        printSummary(trace);
+    }
+    else {
+        printCsv(trace);
+    }
+    return 0;
+}
@@ -0,0 +1,358 @@
+// Microbenchmarks for ResourceManager and ModeSwitchController, driven through
+// the mock clock and parent in tools/shim instead of the simulation kernel
+//
+// Usage: nr_resource_bench [--csv] [--ops N] [--filter <text>]
+//
+// Every case reports the mean time and the number of heap allocations per
+// operation; --filter runs only the cases whose name contains the text.
+
+#include "ResourceManager.h"
+#include "ModeSwitchController.h"
+#include "NRModule.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace nr;
+
+// Every heap allocation of the process goes through here
+static size_t heapAllocations = 0;
+
+void* operator new(std::size_t size)
+{
+    heapAllocations++;
+    void* memory = std::malloc(size ? size : 1);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+struct Options {
+    long ops;
+    bool csv;
+    const char* filter;
+};
+
+struct PoolShape {
+    int subchannels;
+    int symbols;
+};
+
+// Request sizes are drawn uniformly from [minSize, maxSize] blocks
+struct SizeMix {
+    const char* name;
+    int minSize;
+    int maxSize;
+};
+
+static const PoolShape POOL_SHAPES[] = { {10, 14}, {27, 14}, {100, 14} };
+static const double FILL_LEVELS[] = { 0.1, 0.5, 0.9 };
+static const SizeMix SIZE_MIXES[] = { {"small", 1, 4}, {"mixed", 1, 28}, {"large", 14, 56} };
+static const char* const POLICIES[] = { "default", "conservative", "semiPersistent", "sensingFirst" };
+
+static const double SLOT_DURATION = 0.001;
+static const int PERIOD_SLOTS = 100;      ///< Reservation period of the expire cases
+
+/**
+ * @brief Time and heap allocations between construction and finish()
+ */
+class Measurement
+{
+  public:
+    Measurement() :
+        start(std::chrono::steady_clock::now()),
+        startAllocations(heapAllocations)
+    {
+    }
+
+    double elapsedNs() const {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+    size_t allocations() const { return heapAllocations - startAllocations; }
+
+  private:
+    std::chrono::steady_clock::time_point start;
+    size_t startAllocations;
+};
+
+static bool selected(const Options& options, const std::string& name)
+{
+    return !options.filter || name.find(options.filter) != std::string::npos;
+}
+
+static void report(const Options& options, const std::string& name, long ops,
+                   const Measurement& measurement, long failed)
+{
+    double ns = measurement.elapsedNs() / ops;
+    double allocations = static_cast<double>(measurement.allocations()) / ops;
+    double failedRatio = static_cast<double>(failed) / ops;
+    if (options.csv) {
+        std::printf("%s,%ld,%.2f,%.4f,%.4f\n", name.c_str(), ops, ns, allocations, failedRatio);
+    }
+    else {
+        std::printf("%-36s %10.1f ns/op %9.4f allocs/op %7.2f%% failed\n",
+                    name.c_str(), ns, allocations, failedRatio * 100.0);
+    }
+    std::fflush(stdout);
+}
+
+static std::string caseName(const char* kind, const PoolShape& shape, double fill, const SizeMix& mix)
+{
+    char name[96];
+    std::snprintf(name, sizeof(name), "%s/%dx%d/fill%02d/%s", kind, shape.subchannels, shape.symbols,
+                  static_cast<int>(fill * 100 + 0.5), mix.name);
+    return name;
+}
+
+static double meanSize(const SizeMix& mix)
+{
+    return (mix.minSize + mix.maxSize) / 2.0;
+}
+
+/*
+ * Allocate and release with the clock standing still, around a fixed fill
+ * level: each operation releases a random held allocation and allocates a
+ * new one, so the pool fragments as it would under load. Nothing expires.
+ */
+static void benchChurn(const Options& options, const PoolShape& shape, double fill, const SizeMix& mix)
+{
+    std::string name = caseName("churn", shape, fill, mix);
+    if (!selected(options, name)) {
+        return;
+    }
+
+    setSimTime(0);
+    NRModule parent(1);
+    ResourceManager manager(&parent);
+    manager.setSlotDuration(SLOT_DURATION);
+    manager.setPeriodicity(PERIOD_SLOTS * SLOT_DURATION);
+    manager.setPoolSize(shape.subchannels, shape.symbols);
+
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> size(mix.minSize, mix.maxSize);
+    std::uniform_int_distribution<int> priority(0, 7);
+    std::vector<int> held;
+    AllocationResult result;
+
+    // Fill to the target, giving up after a run of failures on small pools
+    for (int misses = 0; manager.getUtilization() < fill && misses < 16; ) {
+        if (manager.allocateSpecific(priority(random), size(random), &result)) {
+            held.push_back(result.resourceId);
+        }
+        else {
+            misses++;
+        }
+    }
+
+    long warmup = options.ops / 10;
+    long failed = 0;
+    std::unique_ptr<Measurement> measurement;
+    for (long op = -warmup; op < options.ops; op++) {
+        if (op == 0) {
+            failed = 0;
+            measurement.reset(new Measurement());
+        }
+        if (!held.empty()) {
+            size_t victim = std::uniform_int_distribution<size_t>(0, held.size() - 1)(random);
+            manager.release(held[victim]);
+            held[victim] = held.back();
+            held.pop_back();
+        }
+        if (manager.allocateSpecific(priority(random), size(random), &result)) {
+            held.push_back(result.resourceId);
+        }
+        else {
+            failed++;
+        }
+    }
+    report(options, name, options.ops, *measurement, failed);
+}
+
+/*
+ * Semi-persistent reservations with the clock advancing slot by slot:
+ * every slot expires the reservations made one period earlier and makes
+ * new ones at the rate that keeps the pool at the fill level. An
+ * operation is one reservation over its whole life, allocation to expiry.
+ */
+static void benchExpire(const Options& options, const PoolShape& shape, double fill, const SizeMix& mix,
+                        bool batch)
+{
+    std::string name = caseName(batch ? "batch" : "expire", shape, fill, mix);
+    if (!selected(options, name)) {
+        return;
+    }
+
+    setSimTime(0);
+    NRModule parent(1);
+    ResourceManager manager(&parent);
+    manager.setSlotDuration(SLOT_DURATION);
+    manager.setPeriodicity(PERIOD_SLOTS * SLOT_DURATION);
+    manager.setPoolSize(shape.subchannels, shape.symbols);
+
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> size(mix.minSize, mix.maxSize);
+    std::uniform_int_distribution<int> priority(0, 7);
+    std::vector<AllocationRequest> requests;
+    std::vector<AllocationResult> results;
+
+    double rate = fill * shape.subchannels * shape.symbols / (meanSize(mix) * PERIOD_SLOTS);
+    double credit = 0;
+    long ops = 0;
+    long failed = 0;
+    std::unique_ptr<Measurement> measurement;
+
+    // One period to reach the steady state before measuring
+    for (int64_t slot = 0; ops < options.ops; slot++) {
+        if (slot == PERIOD_SLOTS) {
+            ops = 0;
+            failed = 0;
+            measurement.reset(new Measurement());
+        }
+        setSimTime(slot * SLOT_DURATION);
+        manager.allocateResources();
+
+        requests.clear();
+        for (credit += rate; credit >= 1; credit -= 1) {
+            requests.push_back(AllocationRequest(priority(random), size(random)));
+        }
+        if (batch) {
+            failed += static_cast<long>(requests.size()) - manager.allocateBatch(requests, results);
+        }
+        else {
+            for (const AllocationRequest& request : requests) {
+                failed += manager.allocateSpecific(request.priority, request.size) ? 0 : 1;
+            }
+        }
+        ops += static_cast<long>(requests.size());
+    }
+    report(options, name, ops, *measurement, failed);
+}
+
+/*
+ * Measurement input to a mode switch controller, one sample per call, with
+ * RSRP wandering around the threshold so that triggers are armed, cancelled
+ * and expire. Expired triggers are handled as the simulation module does.
+ */
+static void benchSwitching(const Options& options, const char* policy)
+{
+    std::string name = std::string("switch/") + policy;
+    if (!selected(options, name)) {
+        return;
+    }
+
+    setSimTime(0);
+    NRModule parent(1);
+    std::unique_ptr<ModeSwitchController> controller(ModeSwitchController::create(policy, &parent));
+    ModeSwitchParams params;
+    params.timeToTrigger = 0.1;
+    controller->setParameters(params);
+
+    std::mt19937 random(1);
+    std::normal_distribution<double> rsrpStep(0.0, 1.0);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    double rsrp = params.rsrpThreshold;
+
+    long warmup = options.ops / 10;
+    long ops = -warmup;
+    std::unique_ptr<Measurement> measurement;
+    for (int64_t slot = 0; ops < options.ops; slot++) {
+        if (ops >= 0 && !measurement) {
+            ops = 0;
+            measurement.reset(new Measurement());
+        }
+        simtime_t now = slot * SLOT_DURATION;
+        setSimTime(now);
+        if (parent.isTriggerDue(now)) {
+            parent.clearTrigger();
+            int newMode = controller->onTriggerExpired();
+            if (newMode >= 0 && !controller->executeSwitch(newMode)) {
+                controller->onSwitchRefused(newMode);
+            }
+        }
+
+        // Bounded random walk, 20 dB either side of the threshold
+        rsrp = std::min(std::max(rsrp + rsrpStep(random), params.rsrpThreshold - 20), params.rsrpThreshold + 20);
+        controller->recordRsrp(rsrp);
+        controller->recordUtilization(uniform(random));
+        bool delivered = uniform(random) < 0.95;
+        controller->recordDelivery(delivered);
+        if (delivered) {
+            controller->recordLatency(0.002 + 0.01 * uniform(random));
+        }
+        ops += delivered ? 4 : 3;
+    }
+    report(options, name, ops, *measurement, 0);
+}
+
+int main(int argc, char** argv)
+{
+    Options options = { 200000, false, nullptr };
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--csv") == 0) {
+            options.csv = true;
+        }
+        else if (std::strcmp(argv[i], "--ops") == 0 && i + 1 < argc) {
+            options.ops = std::atol(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            options.filter = argv[++i];
+        }
+        else {
+            std::fprintf(stderr, "Usage: %s [--csv] [--ops N] [--filter <text>]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (options.ops <= 0) {
+        std::fprintf(stderr, "%s: --ops must be positive\n", argv[0]);
+        return 2;
+    }
+
+    if (options.csv) {
+        std::printf("case,ops,ns_per_op,allocs_per_op,failed_ratio\n");
+    }
+    for (const PoolShape& shape : POOL_SHAPES) {
+        for (double fill : FILL_LEVELS) {
+            for (const SizeMix& mix : SIZE_MIXES) {
+                benchChurn(options, shape, fill, mix);
+                benchExpire(options, shape, fill, mix, false);
+                benchExpire(options, shape, fill, mix, true);
+            }
+        }
+    }
+    for (const char* policy : POLICIES) {
+        benchSwitching(options, policy);
+    }
+    return 0;
+}
@@ -0,0 +1,29 @@
+#!/bin/sh
+# Runs a parallel simulation config on this host, one process per partition.
+# Usage: run_parallel.sh <simulation binary> <config> <partitions> [extra args...]
+set -e
+
+if [ $# -lt 3 ]; then
+    echo "Usage: $0 <simulation binary> <config> <partitions> [extra args...]" >&2
+    exit 1
+fi
+
+binary=$1
+config=$2
+partitions=$3
+shift 3
+
+pids=""
+i=0
+while [ "$i" -lt "$partitions" ]; do
+    "$binary" -u Cmdenv -c "$config" -p"$i,$partitions" "$@" > "partition$i.log" 2>&1 &
+    pids="$pids $!"
+    i=$((i + 1))
+done
+
+# Fail if any partition failed
+status=0
+for pid in $pids; do
+    wait "$pid" || status=1
+done
+exit $status
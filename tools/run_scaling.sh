@@ -0,0 +1,86 @@
+#!/bin/sh
+# Runs every size of the Scaling config and appends one CSV line per size with
+# its throughput and memory, so that scaling can be compared across versions.
+# Usage: run_scaling.sh <simulation binary> [output csv] [extra args...]
+#
+# Run from the simulations directory after generating the scenarios with
+# generate_scaling_scenario.sh. Columns:
+#   version          git describe of the tree the binary was built from
+#   vehicles         numVehicles of the run
+#   events, simTime  event count and simulation time at the end of the run
+#   elapsed          wall time of the event loop in s, as reported by Cmdenv
+#   eventsPerSec, simsecPerSec
+#   peakRssKiB       peak resident set size of the whole process
+#   rssPerVehicleB   peak RSS divided by the number of vehicles
+#   moduleMemoryB    mean of the moduleMemory scalar over the NRModules
+set -e
+
+if [ $# -lt 1 ]; then
+    echo "Usage: $0 <simulation binary> [output csv] [extra args...]" >&2
+    exit 1
+fi
+if [ ! -x /usr/bin/time ]; then
+    echo "$0: /usr/bin/time is needed for the peak RSS" >&2
+    exit 1
+fi
+
+binary=$1
+csv=${2:-results/scaling.csv}
+[ $# -ge 2 ] && shift 2 || shift 1
+results=$(dirname "$csv")
+version=$(git -C "$(dirname "$0")" describe --always --dirty 2>/dev/null || echo unknown)
+
+mkdir -p "$results"
+if [ ! -f "$csv" ]; then
+    echo "version,vehicles,events,simTime,elapsed,eventsPerSec,simsecPerSec,peakRssKiB,rssPerVehicleB,moduleMemoryB" > "$csv"
+fi
+
+# One run per size; the run list maps run numbers to vehicle counts
+"$binary" -u Cmdenv -c Scaling -q runs "$@" |
+    sed -n 's/^Run \([0-9]*\): .*\$vehicles=\([0-9]*\).*/\1 \2/p' > "$results/scaling.runs"
+if [ ! -s "$results/scaling.runs" ]; then
+    echo "$0: no runs found in the Scaling config" >&2
+    exit 1
+fi
+
+status=0
+while read -r run vehicles; do
+    log="$results/Scaling-$vehicles.log"
+    started=$(date +%s.%N)
+    if ! /usr/bin/time -f "%M" -o "$results/Scaling-$vehicles.rss" \
+            "$binary" -u Cmdenv -c Scaling -r "$run" --result-dir="$results" "$@" > "$log" 2>&1 < /dev/null; then
+        echo "$0: run $run ($vehicles vehicles) failed, see $log" >&2
+        status=1
+        continue
+    fi
+    finished=$(date +%s.%N)
+
+    # The last progress line has the event loop time; fall back to the process wall time
+    end=$(sed -n 's/.*at t=\([0-9.e+-]*\)s, event #\([0-9]*\).*/\1 \2/p' "$log" | tail -n 1)
+    [ -n "$end" ] || end=$(sed -n 's/.*Event #\([0-9]*\) *t=\([0-9.e+-]*\).*/\2 \1/p' "$log" | tail -n 1)
+    elapsed=$(sed -n 's/.*Elapsed: \([0-9.]*\)s.*/\1/p' "$log" | tail -n 1)
+    [ -n "$elapsed" ] || elapsed=$(awk -v a="$started" -v b="$finished" 'BEGIN { print b - a }')
+    rss=$(tail -n 1 "$results/Scaling-$vehicles.rss")
+    sca="$results/Scaling-$vehicles.sca"
+    memory=""
+    [ ! -f "$sca" ] || memory=$(awk '$1 == "scalar" && $3 == "moduleMemory" { sum += $4; n++ }
+                                     END { if (n) printf "%.0f", sum / n }' "$sca")
+    if [ -z "$memory" ]; then
+        echo "$0: run $run ($vehicles vehicles) recorded no moduleMemory scalar in $sca;" \
+             "are the vehicles NRVehicles with an nrModule?" >&2
+        status=1
+        continue
+    fi
+
+    echo "$end" | awk -v version="$version" -v vehicles="$vehicles" -v elapsed="$elapsed" \
+                      -v rss="$rss" -v memory="$memory" '
+        { simtime = $1; events = $2 }
+        END {
+            eventRate = elapsed > 0 ? events / elapsed : 0
+            simRate = elapsed > 0 ? simtime / elapsed : 0
+            printf "%s,%d,%d,%g,%g,%.0f,%g,%d,%.0f,%s\n", version, vehicles, events, simtime, elapsed,
+                   eventRate, simRate, rss, rss * 1024 / vehicles, memory
+        }' >> "$csv"
+done < "$results/scaling.runs"
+
+exit $status
@@ -0,0 +1,45 @@
+#ifndef __NR_SHIM_NR_MODULE_H
+#define __NR_SHIM_NR_MODULE_H
+
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+namespace nr {
+
+/**
+ * @brief Mock parent for ResourceManager and ModeSwitchController in the tools
+ *
+ * Has the module id used in trace records and keeps the time-to-trigger
+ * expiry the controller asks for instead of scheduling an event; the
+ * driver calls onTriggerExpired() once its clock reaches it.
+ */
+class NRModule
+{
+  public:
+    explicit NRModule(int id = 0) : id(id), triggerExpiry(-1), triggersScheduled(0) {}
+
+    int getId() const { return id; }
+
+    // Negative cancels, as in the simulation module
+    void scheduleTimeToTrigger(simtime_t expiry) {
+        triggerExpiry = expiry;
+        if (expiry >= 0) {
+            triggersScheduled++;
+        }
+    }
+
+    bool isTriggerDue(simtime_t now) const { return triggerExpiry >= 0 && triggerExpiry <= now; }
+    simtime_t getTriggerExpiry() const { return triggerExpiry; }
+    void clearTrigger() { triggerExpiry = -1; }
+    long getTriggersScheduled() const { return triggersScheduled; }
+
+  private:
+    int id;
+    simtime_t triggerExpiry;    ///< Pending expiry, -1 if none
+    long triggersScheduled;
+};
+
+}  // namespace nr
+
+#endif // __NR_SHIM_NR_MODULE_H
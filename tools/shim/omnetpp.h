@@ -0,0 +1,79 @@
+#ifndef __NR_SHIM_OMNETPP_H
+#define __NR_SHIM_OMNETPP_H
+
+#include <iostream>
+
+/**
+ * @brief Stand-in for <omnetpp.h> used by the tools
+ *
+ * Provides the little of the simulation kernel that ResourceManager,
+ * ModeSwitchController and their helpers use, so that the tools can
+ * drive them without OMNeT++: simtime_t as a double, a clock that the
+ * driver sets with setSimTime(), and EV_* logging to std::clog that is
+ * off unless the driver enables it (as in Cmdenv express mode).
+ */
+namespace omnetpp {
+
+using std::endl;
+
+typedef double simtime_t;
+
+enum LogLevel {
+    LOGLEVEL_TRACE,
+    LOGLEVEL_DEBUG,
+    LOGLEVEL_DETAIL,
+    LOGLEVEL_INFO,
+    LOGLEVEL_WARN,
+    LOGLEVEL_ERROR,
+    LOGLEVEL_FATAL,
+    LOGLEVEL_OFF
+};
+
+class cEnvir
+{
+  public:
+    cEnvir() : loggingEnabled(false) {}
+    bool isLoggingEnabled() const { return loggingEnabled; }
+    void setLoggingEnabled(bool enabled) { loggingEnabled = enabled; }
+
+  private:
+    bool loggingEnabled;
+};
+
+inline cEnvir* getEnvir()
+{
+    static cEnvir envir;
+    return &envir;
+}
+
+// The mock clock; only the driver moves it
+inline simtime_t& currentSimTime()
+{
+    static simtime_t now = 0;
+    return now;
+}
+
+inline simtime_t simTime() { return currentSimTime(); }
+inline void setSimTime(simtime_t now) { currentSimTime() = now; }
+
+}  // namespace omnetpp
+
+#define SIMTIME_ZERO 0.0
+#define SIMTIME_DBL(t) static_cast<double>(t)
+
+#ifndef COMPILETIME_LOGLEVEL
+#define COMPILETIME_LOGLEVEL omnetpp::LOGLEVEL_TRACE
+#endif
+
+#define NR_SHIM_EV(level) \
+    if (!((level) >= COMPILETIME_LOGLEVEL && omnetpp::getEnvir()->isLoggingEnabled())) ; else std::clog
+
+#define EV_FATAL  NR_SHIM_EV(omnetpp::LOGLEVEL_FATAL)
+#define EV_ERROR  NR_SHIM_EV(omnetpp::LOGLEVEL_ERROR)
+#define EV_WARN   NR_SHIM_EV(omnetpp::LOGLEVEL_WARN)
+#define EV_INFO   NR_SHIM_EV(omnetpp::LOGLEVEL_INFO)
+#define EV_DETAIL NR_SHIM_EV(omnetpp::LOGLEVEL_DETAIL)
+#define EV_DEBUG  NR_SHIM_EV(omnetpp::LOGLEVEL_DEBUG)
+#define EV_TRACE  NR_SHIM_EV(omnetpp::LOGLEVEL_TRACE)
+
+#endif // __NR_SHIM_OMNETPP_H
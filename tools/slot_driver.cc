@@ -0,0 +1,355 @@
+// Headless slot-level driver: runs the ResourceManagers of N virtual UEs under
+// synthetic periodic and aperiodic traffic, without the simulation kernel
+//
+// Usage: nr_slot_driver [options]
+//   --ues N                 virtual UEs (100)
+//   --slots N               slots to simulate (100000)
+//   --numerology N          5G NR numerology, slot length 1 ms / 2^N (1)
+//   --subchannels N         pool size passed to setPoolSize (27)
+//   --symbols N             (14)
+//   --reservation MS        time a grant holds its blocks (100)
+//   --period MS             periodic packet interval per UE, 0 disables (100)
+//   --periodic-size A:B     blocks per periodic request, uniform (2:6)
+//   --periodic-priority N   (4)
+//   --aperiodic-rate R      aperiodic packets per second per UE, Poisson (0)
+//   --aperiodic-size A:B    blocks per aperiodic request, uniform (1:8)
+//   --aperiodic-priority N  (2)
+//   --load L                offered load per pool, 0..1; sets --aperiodic-rate
+//   --preemption            let higher priorities evict lower ones
+//   --seed N                (1)
+//   --per-ue FILE           also write the statistics of every UE as CSV
+//
+// Requests are queued and served at the next slot boundary with
+// allocateBatch(), as NRModule does with eventDrivenAllocation; UEs are
+// only visited in slots where a request arrives or a grant expires. The
+// statistics use the names of the NRModule scalars and are printed as
+// statistic,value CSV. activationsPerSecond is the rate of UE visits
+// actually processed; virtualUeSlotsPerSecond counts every UE slot of the
+// run, skipped ones included, and is only comparable to a driver that
+// visits every UE in every slot.
+
+#include "ResourceManager.h"
+#include "NRModule.h"
+#include "TimingWheel.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace nr;
+
+struct SizeRange {
+    int minSize;
+    int maxSize;
+
+    double mean() const { return (minSize + maxSize) / 2.0; }
+};
+
+struct Options {
+    int ues;
+    int64_t slots;
+    int numerology;
+    int subchannels;
+    int symbols;
+    double reservationMs;
+    double periodMs;
+    SizeRange periodicSize;
+    int periodicPriority;
+    double aperiodicRate;
+    SizeRange aperiodicSize;
+    int aperiodicPriority;
+    double load;                    ///< Negative unless --load is given
+    bool preemption;
+    unsigned seed;
+    const char* perUeFile;
+};
+
+/**
+ * @brief One UE: its ResourceManager, mock parent and traffic state
+ */
+struct VirtualUe {
+    NRModule parent;
+    ResourceManager manager;
+    int64_t nextPeriodicSlot;       ///< -1 without periodic traffic
+    double nextAperiodicTime;       ///< In slots, -1 without aperiodic traffic
+    std::vector<AllocationRequest> pending;
+    std::vector<AllocationResult> results;
+
+    explicit VirtualUe(int id) :
+        parent(id),
+        manager(&parent),
+        nextPeriodicSlot(-1),
+        nextAperiodicTime(-1)
+    {
+    }
+};
+
+static bool parseRange(const char* text, SizeRange& range)
+{
+    return std::sscanf(text, "%d:%d", &range.minSize, &range.maxSize) == 2 &&
+           range.minSize > 0 && range.maxSize >= range.minSize;
+}
+
+static void usage(const char* program)
+{
+    std::fprintf(stderr,
+        "Usage: %s [--ues N] [--slots N] [--numerology N] [--subchannels N] [--symbols N]\n"
+        "       [--reservation MS] [--period MS] [--periodic-size A:B] [--periodic-priority N]\n"
+        "       [--aperiodic-rate R] [--aperiodic-size A:B] [--aperiodic-priority N]\n"
+        "       [--load L] [--preemption] [--seed N] [--per-ue FILE]\n", program);
+}
+
+static bool parseOptions(int argc, char** argv, Options& options)
+{
+    options = Options{100, 100000, 1, 27, 14, 100.0, 100.0, {2, 6}, 4, 0.0, {1, 8}, 2, -1.0, false, 1, nullptr};
+    for (int i = 1; i < argc; i++) {
+        const char* name = argv[i];
+        if (std::strcmp(name, "--preemption") == 0) {
+            options.preemption = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (std::strcmp(name, "--ues") == 0) {
+            options.ues = std::atoi(value);
+        }
+        else if (std::strcmp(name, "--slots") == 0) {
+            options.slots = std::atoll(value);
+        }
+        else if (std::strcmp(name, "--numerology") == 0) {
+            options.numerology = std::atoi(value);
+        }
+        else if (std::strcmp(name, "--subchannels") == 0) {
+            options.subchannels = std::atoi(value);
+        }
+        else if (std::strcmp(name, "--symbols") == 0) {
+            options.symbols = std::atoi(value);
+        }
+        else if (std::strcmp(name, "--reservation") == 0) {
+            options.reservationMs = std::atof(value);
+        }
+        else if (std::strcmp(name, "--period") == 0) {
+            options.periodMs = std::atof(value);
+        }
+        else if (std::strcmp(name, "--periodic-size") == 0) {
+            if (!parseRange(value, options.periodicSize)) {
+                return false;
+            }
+        }
+        else if (std::strcmp(name, "--periodic-priority") == 0) {
+            options.periodicPriority = std::atoi(value);
+        }
+        else if (std::strcmp(name, "--aperiodic-rate") == 0) {
+            options.aperiodicRate = std::atof(value);
+        }
+        else if (std::strcmp(name, "--aperiodic-size") == 0) {
+            if (!parseRange(value, options.aperiodicSize)) {
+                return false;
+            }
+        }
+        else if (std::strcmp(name, "--aperiodic-priority") == 0) {
+            options.aperiodicPriority = std::atoi(value);
+        }
+        else if (std::strcmp(name, "--load") == 0) {
+            options.load = std::atof(value);
+        }
+        else if (std::strcmp(name, "--seed") == 0) {
+            options.seed = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        }
+        else if (std::strcmp(name, "--per-ue") == 0) {
+            options.perUeFile = value;
+        }
+        else {
+            return false;
+        }
+    }
+    return options.ues > 0 && options.slots > 0 && options.numerology >= 0 && options.numerology <= 4 &&
+           options.reservationMs > 0 && options.periodMs >= 0 && options.aperiodicRate >= 0;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    double slotDuration = 0.001 / (1 << options.numerology);
+    double slotsPerMs = 0.001 / slotDuration;
+    int64_t periodSlots = static_cast<int64_t>(std::llround(options.periodMs * slotsPerMs));
+    double reservationSlots = std::ceil(options.reservationMs * slotsPerMs - 1e-9);
+    int blocks = options.subchannels * options.symbols;
+
+    // Offered load: blocks held on average over the pool size
+    double periodicLoad = periodSlots > 0 ?
+        options.periodicSize.mean() * reservationSlots / periodSlots / blocks : 0.0;
+    if (options.load >= 0) {
+        double remaining = options.load - periodicLoad;
+        if (remaining < 0) {
+            std::fprintf(stderr, "%s: periodic traffic alone offers a load of %g\n", argv[0], periodicLoad);
+            return 2;
+        }
+        double perSlot = remaining * blocks / (options.aperiodicSize.mean() * reservationSlots);
+        options.aperiodicRate = perSlot / slotDuration;
+    }
+    double aperiodicPerSlot = options.aperiodicRate * slotDuration;
+    double offeredLoad = periodicLoad +
+        aperiodicPerSlot * options.aperiodicSize.mean() * reservationSlots / blocks;
+
+    std::mt19937_64 random(options.seed);
+    std::uniform_int_distribution<int> periodicSize(options.periodicSize.minSize, options.periodicSize.maxSize);
+    std::uniform_int_distribution<int> aperiodicSize(options.aperiodicSize.minSize, options.aperiodicSize.maxSize);
+    std::exponential_distribution<double> aperiodicGap(aperiodicPerSlot > 0 ? aperiodicPerSlot : 1.0);
+
+    // UEs are keyed in the wheel by the next slot they have something to do in
+    TimingWheel schedule(static_cast<int>(std::max<int64_t>(periodSlots, 1024)));
+    std::vector<std::unique_ptr<VirtualUe>> ues;
+    ues.reserve(options.ues);
+    try {
+        for (int i = 0; i < options.ues; i++) {
+            std::unique_ptr<VirtualUe> ue(new VirtualUe(i));
+            ue->manager.setSlotDuration(slotDuration);
+            ue->manager.setPeriodicity(reservationSlots * slotDuration);
+            ue->manager.setPreemptionEnabled(options.preemption);
+            ue->manager.setPoolSize(options.subchannels, options.symbols);
+
+            // Periodic traffic starts at a random phase, so UEs do not all arrive together
+            int64_t first = -1;
+            if (periodSlots > 0) {
+                ue->nextPeriodicSlot = std::uniform_int_distribution<int64_t>(0, periodSlots - 1)(random);
+                first = ue->nextPeriodicSlot;
+            }
+            if (aperiodicPerSlot > 0) {
+                ue->nextAperiodicTime = aperiodicGap(random);
+                int64_t served = static_cast<int64_t>(std::floor(ue->nextAperiodicTime)) + 1;
+                first = first < 0 ? served : std::min(first, served);
+            }
+            if (first >= 0) {
+                schedule.schedule(first, i);
+            }
+            ues.push_back(std::move(ue));
+        }
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+        return 2;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<int> due;
+    long activations = 0;
+    long requests = 0;
+    for (int64_t slot = 0; slot < options.slots; slot++) {
+        due.clear();
+        schedule.advance(slot, due);
+        if (due.empty()) {
+            continue;
+        }
+        setSimTime(slot * slotDuration);
+
+        for (int index : due) {
+            VirtualUe& ue = *ues[index];
+            activations++;
+
+            // Requests arriving up to this slot boundary are served in one batch
+            if (ue.nextPeriodicSlot >= 0 && ue.nextPeriodicSlot <= slot) {
+                ue.pending.push_back(AllocationRequest(options.periodicPriority, periodicSize(random)));
+                ue.nextPeriodicSlot += periodSlots;
+            }
+            while (ue.nextAperiodicTime >= 0 && ue.nextAperiodicTime < slot) {
+                ue.pending.push_back(AllocationRequest(options.aperiodicPriority, aperiodicSize(random)));
+                ue.nextAperiodicTime += aperiodicGap(random);
+            }
+
+            // The same order as NRModule::processResourceAllocation
+            if (ue.manager.allocateResources()) {
+                ue.manager.allocateBatch(ue.pending, ue.results);
+            }
+            requests += static_cast<long>(ue.pending.size());
+            ue.pending.clear();
+
+            // Next arrival or expiry, whichever is first
+            int64_t next = ue.nextPeriodicSlot;
+            if (ue.nextAperiodicTime >= 0) {
+                int64_t served = static_cast<int64_t>(std::floor(ue.nextAperiodicTime)) + 1;
+                next = next < 0 ? served : std::min(next, served);
+            }
+            simtime_t expiry = ue.manager.getNextExpiryTime();
+            if (expiry >= 0) {
+                int64_t expirySlot = static_cast<int64_t>(std::ceil(expiry / slotDuration - 1e-9));
+                next = next < 0 ? expirySlot : std::min(next, expirySlot);
+            }
+            if (next >= 0) {
+                schedule.schedule(std::max(next, slot + 1), index);
+            }
+        }
+    }
+    double wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Statistics as NRModule::finish records them, at the end of the last slot
+    setSimTime(options.slots * slotDuration);
+    long totalAllocations = 0;
+    long failedAllocations = 0;
+    long totalPreemptions = 0;
+    double utilization = 0;
+    double meanUtilization = 0;
+    FILE* perUe = nullptr;
+    if (options.perUeFile) {
+        perUe = std::fopen(options.perUeFile, "w");
+        if (!perUe) {
+            std::fprintf(stderr, "%s: cannot write %s\n", argv[0], options.perUeFile);
+            return 1;
+        }
+        std::fprintf(perUe, "ue,totalAllocations,failedAllocations,totalPreemptions,"
+                            "resourceUtilization,meanResourceUtilization\n");
+    }
+    for (size_t i = 0; i < ues.size(); i++) {
+        const ResourceManager& manager = ues[i]->manager;
+        totalAllocations += manager.getTotalAllocations();
+        failedAllocations += manager.getFailedAllocations();
+        totalPreemptions += manager.getTotalPreemptions();
+        utilization += manager.getUtilization();
+        meanUtilization += manager.getMeanUtilization();
+        if (perUe) {
+            std::fprintf(perUe, "%zu,%d,%d,%d,%g,%g\n", i, manager.getTotalAllocations(),
+                         manager.getFailedAllocations(), manager.getTotalPreemptions(),
+                         manager.getUtilization(), manager.getMeanUtilization());
+        }
+    }
+    if (perUe) {
+        std::fclose(perUe);
+    }
+
+    long attempts = totalAllocations + failedAllocations;
+    std::printf("statistic,value\n");
+    std::printf("ues,%d\n", options.ues);
+    std::printf("slots,%lld\n", static_cast<long long>(options.slots));
+    std::printf("slotDuration,%g\n", slotDuration);
+    std::printf("poolBlocks,%d\n", blocks);
+    std::printf("offeredLoad,%g\n", offeredLoad);
+    std::printf("requests,%ld\n", requests);
+    std::printf("totalAllocations,%ld\n", totalAllocations);
+    std::printf("failedAllocations,%ld\n", failedAllocations);
+    std::printf("failedRatio,%g\n", attempts > 0 ? static_cast<double>(failedAllocations) / attempts : 0.0);
+    std::printf("totalPreemptions,%ld\n", totalPreemptions);
+    std::printf("resourceUtilization,%g\n", utilization / options.ues);
+    std::printf("meanResourceUtilization,%g\n", meanUtilization / options.ues);
+    std::printf("activations,%ld\n", activations);
+    std::printf("wallTime,%g\n", wallTime);
+    std::printf("slotsPerSecond,%g\n", wallTime > 0 ? options.slots / wallTime : 0.0);
+    std::printf("activationsPerSecond,%g\n", wallTime > 0 ? activations / wallTime : 0.0);
+
+    // UE slots simulated per second, most of them skipped rather than processed
+    std::printf("virtualUeSlotsPerSecond,%g\n",
+                wallTime > 0 ? options.slots * static_cast<double>(options.ues) / wallTime : 0.0);
+    return 0;
+}
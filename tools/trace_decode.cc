@@ -0,0 +1,71 @@
+// Decodes a trace file written by nr::TraceRing into CSV or a per-event summary
+//
+// Usage: nr_trace_decode [--summary] <trace file>
+
+#include "TraceRing.h"
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <vector>
+
+using namespace nr;
+
+static void printCsv(const std::vector<TraceRecord>& records)
+{
+    std::printf("slot,ue,event,aux,firstBlock,blockCount\n");
+    for (const TraceRecord& r : records) {
+        std::printf("%lld,%d,%s,%u,%d,%d\n", static_cast<long long>(r.slot), r.ue,
+                    TraceRing::eventName(r.event), static_cast<unsigned>(r.aux), r.firstBlock, r.blockCount);
+    }
+}
+
+static void printSummary(const TraceFileHeader& header, const std::vector<TraceRecord>& records)
+{
+    std::map<uint16_t, unsigned long> counts;
+    for (const TraceRecord& r : records) {
+        counts[r.event]++;
+    }
+
+    std::printf("records appended: %llu\n", static_cast<unsigned long long>(header.totalRecords));
+    std::printf("records stored:   %llu\n", static_cast<unsigned long long>(header.storedRecords));
+    if (!records.empty()) {
+        std::printf("slots:            %lld .. %lld\n",
+                    static_cast<long long>(records.front().slot), static_cast<long long>(records.back().slot));
+    }
+    for (const auto& entry : counts) {
+        std::printf("%-18s%lu\n", TraceRing::eventName(entry.first), entry.second);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool summary = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--summary") == 0) {
+            summary = true;
+        }
+        else {
+            path = argv[i];
+        }
+    }
+    if (!path) {
+        std::fprintf(stderr, "Usage: %s [--summary] <trace file>\n", argv[0]);
+        return 2;
+    }
+
+    TraceFileHeader header;
+    std::vector<TraceRecord> records;
+    if (!TraceRing::load(path, header, records)) {
+        std::fprintf(stderr, "%s: not a readable trace file\n", path);
+        return 1;
+    }
+
+    if (summary) {
+        printSummary(header, records);
+    }
+    else {
+        printCsv(records);
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,320 @@
+// Check that the windowed statistics do not depend on the tick schedule: runs
+// one scripted request sequence through a ticked-every-slot node and an
+// event-driven node and compares their statistics windows one by one
+//
+// Usage: nr_window_check [--slots N] [--window N] [--seed N]
+//
+// The nodes follow NRModule: a tick allocates, serves the queued requests
+// and then samples, slots without a tick repeat the last samples, and
+// direct requests and releases close the run of repeated samples at the
+// first slot starting at or after them. Requests made at a slot boundary
+// come before the tick of that slot. The utilization EWMA and quantile of
+// the mode switch controller are fed the same way and compared at the end.
+// Exits with 1 on the first mismatch.
+
+#include "ResourceManager.h"
+#include "MetricEstimators.h"
+#include "NRModule.h"
+#include "SlotStatistics.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace nr;
+
+static const double SLOT_DURATION = 0.0005;
+
+enum class StepKind { QUEUE, REQUEST, RELEASE };
+
+struct Step {
+    double time;
+    StepKind kind;
+    int priority;
+    int size;                       ///< For RELEASE, index into the granted ids
+};
+
+// One closed window of one signal
+struct Window {
+    int64_t index;
+    long count;
+    double mean;
+    double min;
+    double max;
+    std::vector<long> buckets;
+};
+
+static int64_t slotAt(double time)
+{
+    return static_cast<int64_t>(std::floor(time / SLOT_DURATION + 1e-9));
+}
+
+static int64_t firstSlotAtOrAfter(double time)
+{
+    return static_cast<int64_t>(std::ceil(time / SLOT_DURATION - 1e-9));
+}
+
+/**
+ * @brief The statistics path of NRModule around a shimmed ResourceManager
+ */
+class Node : public SlotStatistics::Listener
+{
+  public:
+    Node(bool eventDriven, int64_t windowSlots) :
+        manager(&parent),
+        eventDriven(eventDriven),
+        lastTick(0),
+        ticks(0)
+    {
+        manager.setSlotDuration(SLOT_DURATION);
+        manager.setPeriodicity(0.005);
+        manager.setPoolSize(4, 14);
+        allocation = statistics.addSignal(-1, 2, 3, 1);
+        utilization = statistics.addSignal(0, 1, 10, 0);
+        statistics.configure(windowSlots, this);
+        statistics.start(0);
+        windows.resize(2);
+        utilizationQuantile.configure(500, 0, 1, 100);
+    }
+
+    // Next tick, the end of time if there is none
+    int64_t nextTick() const
+    {
+        if (!eventDriven) {
+            return lastTick + 1;
+        }
+        int64_t next = std::numeric_limits<int64_t>::max();
+        if (!pending.empty()) {
+            next = std::max(firstSlotAtOrAfter(simTime()), statistics.getLastSlot() + 1);
+        }
+        simtime_t expiry = manager.getNextExpiryTime();
+        if (expiry >= 0) {
+            next = std::min(next, std::max(firstSlotAtOrAfter(expiry), statistics.getLastSlot() + 1));
+        }
+        return next;
+    }
+
+    void tick(int64_t slot)
+    {
+        setSimTime(slot * SLOT_DURATION);
+        catchUp(slot);
+        long result = 0;
+        if (manager.allocateResources()) {
+            if (!pending.empty()) {
+                manager.allocateBatch(pending, results);
+                for (const AllocationResult& granted : results) {
+                    if (granted.granted()) {
+                        grants.push_back(granted.resourceId);
+                    }
+                }
+                pending.clear();
+            }
+            result = 1;
+        }
+        bool newSlot = slot > statistics.getLastSlot();
+        statistics.setIdleValue(allocation, result);
+        statistics.setIdleValue(utilization, manager.getUtilization());
+        if (newSlot) {
+            statistics.record(slot, allocation, result);
+            statistics.record(slot, utilization, manager.getUtilization());
+            utilizationEwma.add(manager.getUtilization());
+            utilizationQuantile.add(manager.getUtilization());
+        }
+        lastTick = slot;
+    }
+
+    void apply(const Step& step)
+    {
+        setSimTime(step.time);
+        if (step.kind == StepKind::QUEUE) {
+            pending.push_back(AllocationRequest(step.priority, step.size));
+            return;
+        }
+        if (step.kind == StepKind::REQUEST) {
+            AllocationResult result;
+            if (manager.allocateSpecific(step.priority, step.size, &result)) {
+                grants.push_back(result.resourceId);
+            }
+        }
+        else if (!grants.empty()) {
+            // Ids of expired grants are unknown to the manager by now
+            int id = grants[step.size % grants.size()];
+            try {
+                manager.release(id);
+            }
+            catch (const std::exception&) {
+            }
+        }
+        catchUp(firstSlotAtOrAfter(step.time));
+        statistics.setIdleValue(utilization, manager.getUtilization());
+    }
+
+    void finish(double time)
+    {
+        setSimTime(time);
+        catchUp(slotAt(time) + 1);
+        statistics.flush();
+    }
+
+    // Skipped slots reach the estimators as one repeated sample
+    void catchUp(int64_t endSlot)
+    {
+        long skipped = statistics.catchUp(endSlot);
+        utilizationEwma.add(statistics.getIdleValue(utilization), skipped);
+        utilizationQuantile.add(statistics.getIdleValue(utilization), skipped);
+    }
+
+    virtual void windowClosed(const SlotStatistics& closed) override
+    {
+        for (int signal : {allocation, utilization}) {
+            const SignalAggregator& window = closed.getWindow(signal);
+            Window copy{closed.getWindowIndex(), window.getCount(), window.getMean(),
+                        window.getMin(), window.getMax(), {}};
+            for (int i = 0; i < window.getNumBuckets(); i++) {
+                copy.buckets.push_back(window.getBucketCount(i));
+            }
+            windows[signal].push_back(copy);
+        }
+    }
+
+    const std::vector<Window>& getWindows(int signal) const { return windows[signal]; }
+    const EwmaEstimator& getUtilizationEwma() const { return utilizationEwma; }
+    const WindowedQuantile& getUtilizationQuantile() const { return utilizationQuantile; }
+    long getTicks() const { return ticks; }
+    void countTick() { ticks++; }
+
+  private:
+    NRModule parent;
+    ResourceManager manager;
+    SlotStatistics statistics;
+    bool eventDriven;
+    int64_t lastTick;
+    long ticks;
+    int allocation;
+    int utilization;
+    std::vector<AllocationRequest> pending;
+    std::vector<AllocationResult> results;
+    std::vector<int> grants;
+    std::vector<std::vector<Window>> windows;
+    EwmaEstimator utilizationEwma;
+    WindowedQuantile utilizationQuantile;
+};
+
+// Steps in time order; at a slot boundary the steps come before the tick
+static void run(Node& node, const std::vector<Step>& steps, int64_t slots)
+{
+    size_t next = 0;
+    for (;;) {
+        int64_t tick = node.nextTick();
+        if (next < steps.size() && steps[next].time <= tick * SLOT_DURATION + 1e-12) {
+            node.apply(steps[next++]);
+            continue;
+        }
+        if (tick >= slots) {
+            break;
+        }
+        node.tick(tick);
+        node.countTick();
+    }
+    node.finish((slots - 0.5) * SLOT_DURATION);
+}
+
+static bool compare(const char* name, const std::vector<Window>& periodic, const std::vector<Window>& eventDriven)
+{
+    if (periodic.size() != eventDriven.size()) {
+        std::fprintf(stderr, "%s: %zu windows periodic, %zu event-driven\n", name, periodic.size(), eventDriven.size());
+        return false;
+    }
+    for (size_t i = 0; i < periodic.size(); i++) {
+        const Window& a = periodic[i];
+        const Window& b = eventDriven[i];
+        if (a.index != b.index || a.count != b.count || a.buckets != b.buckets ||
+            a.min != b.min || a.max != b.max || std::fabs(a.mean - b.mean) > 1e-9) {
+            std::fprintf(stderr, "%s: window %lld differs: count %ld/%ld, mean %g/%g, min %g/%g, max %g/%g\n",
+                         name, static_cast<long long>(a.index), a.count, b.count, a.mean, b.mean,
+                         a.min, b.min, a.max, b.max);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    int64_t slots = 20000;
+    int64_t windowSlots = 7;
+    unsigned seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--slots") == 0) {
+            slots = std::atoll(argv[i + 1]);
+        }
+        else if (std::strcmp(argv[i], "--window") == 0) {
+            windowSlots = std::atoll(argv[i + 1]);
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0) {
+            seed = static_cast<unsigned>(std::strtoul(argv[i + 1], nullptr, 10));
+        }
+        else {
+            std::fprintf(stderr, "Usage: %s [--slots N] [--window N] [--seed N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if ((argc - 1) % 2 != 0 || slots <= 0 || windowSlots <= 0) {
+        std::fprintf(stderr, "Usage: %s [--slots N] [--window N] [--seed N]\n", argv[0]);
+        return 2;
+    }
+
+    // Sparse traffic, so that the event-driven node skips runs of slots; a third
+    // of the steps fall on a slot boundary
+    std::mt19937 random(seed);
+    std::vector<Step> steps;
+    double time = 0;
+    while (true) {
+        time += std::exponential_distribution<double>(1.0 / 6.0)(random) * SLOT_DURATION;
+        if (std::uniform_int_distribution<int>(0, 2)(random) == 0) {
+            time = firstSlotAtOrAfter(time) * SLOT_DURATION;
+        }
+        if (time >= slots * SLOT_DURATION) {
+            break;
+        }
+        int kind = std::uniform_int_distribution<int>(0, 2)(random);
+        steps.push_back(Step{time, static_cast<StepKind>(kind),
+                             std::uniform_int_distribution<int>(0, 7)(random),
+                             std::uniform_int_distribution<int>(1, 12)(random)});
+    }
+
+    Node periodic(false, windowSlots);
+    Node eventDriven(true, windowSlots);
+    run(periodic, steps, slots);
+    run(eventDriven, steps, slots);
+
+    bool same = compare("resourceAllocation", periodic.getWindows(0), eventDriven.getWindows(0)) &&
+                compare("sidelinkQuality", periodic.getWindows(1), eventDriven.getWindows(1));
+    const EwmaEstimator& periodicEwma = periodic.getUtilizationEwma();
+    const EwmaEstimator& eventDrivenEwma = eventDriven.getUtilizationEwma();
+    if (same && (periodicEwma.getCount() != eventDrivenEwma.getCount() ||
+                 std::fabs(periodicEwma.getValue() - eventDrivenEwma.getValue()) > 1e-9)) {
+        std::fprintf(stderr, "utilization EWMA: %g over %ld slots periodic, %g over %ld event-driven\n",
+                     periodicEwma.getValue(), periodicEwma.getCount(),
+                     eventDrivenEwma.getValue(), eventDrivenEwma.getCount());
+        same = false;
+    }
+    for (double q : {0.1, 0.5, 0.9}) {
+        double a = periodic.getUtilizationQuantile().quantile(q);
+        double b = eventDriven.getUtilizationQuantile().quantile(q);
+        if (same && std::fabs(a - b) > 1e-9) {
+            std::fprintf(stderr, "utilization quantile %g: %g periodic, %g event-driven\n", q, a, b);
+            same = false;
+        }
+    }
+    std::printf("steps,%zu\n", steps.size());
+    std::printf("windows,%zu\n", periodic.getWindows(1).size());
+    std::printf("periodicTicks,%ld\n", periodic.getTicks());
+    std::printf("eventDrivenTicks,%ld\n", eventDriven.getTicks());
+    std::printf("result,%s\n", same ? "same" : "different");
+    return same ? 0 : 1;
+}